@@ -0,0 +1,103 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+// Batched lookups (find_batch) against a scalar find loop on int64_t keys,
+// for request-sized batches of random probes, and coroutine lookups fed
+// one key at a time through a lookup_scheduler.
+// Usage: bench_batch [elements...]   (default: 1000000 100000000)
+
+#include "jump_list.h"
+#include "jump_list_async.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+using list_type = jump_list<std::int64_t>;
+using ns = std::chrono::duration<double, std::nano>;
+
+constexpr std::size_t total_probes = 4'000'000;
+
+void run(std::size_t n) {
+    std::mt19937_64 rng(42);
+    std::vector<std::int64_t> keys(n);
+    for (auto& k : keys) {
+        k = static_cast<std::int64_t>(rng() >> 1);
+    }
+    // Random insertion order scatters the nodes over the heap the way a
+    // long-lived list would.
+    list_type list;
+    for (auto k : keys) {
+        list.insert(k);
+    }
+
+    std::vector<std::int64_t> probes(total_probes);
+    for (auto& p : probes) {
+        p = keys[rng() % n];
+    }
+    std::vector<list_type::iterator> out(total_probes);
+
+    std::printf("elements %zu\n", n);
+    std::printf("%8s %14s %14s %8s\n", "batch", "find ns/key", "batch ns/key", "speedup");
+    for (std::size_t batch : {256u, 1024u, 4096u}) {
+        std::size_t rounds = total_probes / batch;
+        std::size_t found = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (std::size_t r = 0; r < rounds; ++r) {
+            for (std::size_t i = r * batch; i < (r + 1) * batch; ++i) {
+                out[i] = list.find(probes[i]);
+            }
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        for (std::size_t r = 0; r < rounds; ++r) {
+            list.find_batch(std::span(probes).subspan(r * batch, batch), std::span(out).subspan(r * batch, batch));
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < rounds * batch; ++i) {
+            found += out[i] != list.end();
+        }
+        double keys_done = static_cast<double>(rounds * batch);
+        double scalar = ns(t1 - t0).count() / keys_done;
+        double batched = ns(t2 - t1).count() / keys_done;
+        std::printf("%8zu %14.1f %14.1f %7.2fx\n", batch, scalar, batched, scalar / batched);
+        if (found != rounds * batch) {
+            std::printf("lookup mismatch\n");
+        }
+    }
+
+    std::printf("%8s %14s\n", "width", "async ns/key");
+    for (std::size_t width : {8u, 16u, 32u, 64u}) {
+        std::size_t found = 0;
+        auto count = [&](std::size_t, list_type::const_iterator it) { found += it != list.end(); };
+        lookup_scheduler<list_type, decltype(count)> scheduler(list, count, width);
+        auto t0 = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < total_probes; ++i) {
+            scheduler.submit(probes[i], i);
+        }
+        scheduler.drain();
+        auto t1 = std::chrono::steady_clock::now();
+        std::printf("%8zu %14.1f\n", width, ns(t1 - t0).count() / static_cast<double>(total_probes));
+        if (found != total_probes) {
+            std::printf("lookup mismatch\n");
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            run(std::strtoull(argv[i], nullptr, 10));
+        }
+    } else {
+        run(1'000'000);
+        run(100'000'000);
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+// Throughput versus thread count for concurrent_jump_list, for a
+// sharded_jump_list and for a jump_list guarded by one std::mutex. Mixed
+// workload: 80% contains, 10% insert, 10% erase on uniformly random keys.
+// Usage: bench_concurrent [max_threads = 32] [ops_per_thread = 1000000] [keys = 1000000]
+
+#include "concurrent_jump_list.h"
+#include "jump_list.h"
+#include "sharded_jump_list.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct locked_list {
+    std::mutex mutex;
+    jump_list<std::uint64_t> list;
+
+    bool insert(std::uint64_t k) {
+        std::lock_guard lock(mutex);
+        if (list.contains(k)) {
+            return false;
+        }
+        list.insert(k);
+        return true;
+    }
+
+    bool erase(std::uint64_t k) {
+        std::lock_guard lock(mutex);
+        return list.erase(k) != 0;
+    }
+
+    bool contains(std::uint64_t k) {
+        std::lock_guard lock(mutex);
+        return list.contains(k);
+    }
+};
+
+// The check and the insert take the shard lock separately, so racing
+// inserts of one key may both succeed; erase removes every copy.
+struct sharded_list {
+    sharded_jump_list<std::uint64_t> list;
+
+    bool insert(std::uint64_t k) {
+        if (list.contains(k)) {
+            return false;
+        }
+        list.insert(k);
+        return true;
+    }
+
+    bool erase(std::uint64_t k) { return list.erase(k) != 0; }
+
+    bool contains(std::uint64_t k) { return list.contains(k); }
+};
+
+template<typename List>
+double run(List& list, int threads, std::size_t ops, std::uint64_t keys) {
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> sink{0};
+    auto t0 = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937_64 rng(static_cast<std::uint64_t>(t) + 1);
+            std::size_t hits = 0;
+            for (std::size_t i = 0; i < ops; ++i) {
+                std::uint64_t k = rng() % keys;
+                unsigned dice = static_cast<unsigned>(rng() % 10);
+                if (dice == 0) {
+                    hits += list.insert(k);
+                } else if (dice == 1) {
+                    hits += list.erase(k);
+                } else {
+                    hits += list.contains(k);
+                }
+            }
+            sink += hits;
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+    return static_cast<double>(ops) * threads / seconds / 1e6;
+}
+
+template<typename List>
+void prefill(List& list, std::uint64_t keys) {
+    std::mt19937_64 rng(0);
+    for (std::uint64_t i = 0; i < keys / 2; ++i) {
+        list.insert(rng() % keys);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : 32;
+    std::size_t ops = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000'000;
+    std::uint64_t keys = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1'000'000;
+
+    std::printf("%8s %18s %18s %18s\n", "threads", "lock-free Mops/s", "sharded Mops/s", "mutex Mops/s");
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        concurrent_jump_list<std::uint64_t> lock_free;
+        sharded_list sharded;
+        locked_list locked;
+        prefill(lock_free, keys);
+        prefill(sharded, keys);
+        prefill(locked, keys);
+        double a = run(lock_free, threads, ops, keys);
+        double b = run(sharded, threads, ops, keys);
+        double c = run(locked, threads, ops, keys);
+        std::printf("%8d %18.2f %18.2f %18.2f\n", threads, a, b, c);
+    }
+    return 0;
+}
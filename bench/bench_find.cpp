@@ -0,0 +1,65 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+// Point lookup throughput on int64_t keys, for the plain layout, for fat
+// nodes of 16 and 32 keys and for compact links.
+// Usage: bench_find [elements = 10000000] [lookups = 10000000]
+
+#include "jump_list.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+using key = std::int64_t;
+
+template<typename List>
+void run(const char* layout, const std::vector<key>& keys, const std::vector<key>& probes) {
+    List list;
+    auto t0 = std::chrono::steady_clock::now();
+    for (auto k : keys) {
+        list.insert(k);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    std::size_t found = 0;
+    auto t2 = std::chrono::steady_clock::now();
+    for (auto p : probes) {
+        found += list.find(p) != list.end();
+    }
+    auto t3 = std::chrono::steady_clock::now();
+
+    using ns = std::chrono::duration<double, std::nano>;
+    std::printf("%-10s %14.1f %14.1f %12zu\n", layout, ns(t1 - t0).count() / static_cast<double>(keys.size()),
+                ns(t3 - t2).count() / static_cast<double>(probes.size()), found);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    std::size_t lookups = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10'000'000;
+
+    std::mt19937_64 rng(42);
+    std::vector<key> keys(n);
+    for (auto& k : keys) {
+        k = static_cast<key>(rng() >> 1);
+    }
+    std::vector<key> probes(lookups);
+    for (auto& p : probes) {
+        p = keys[rng() % n];
+    }
+
+    std::printf("elements %zu\n", n);
+    std::printf("%-10s %14s %14s %12s\n", "layout", "insert ns/op", "find ns/op", "found");
+    run<jump_list<key>>("plain", keys, probes);
+    run<jump_list<key, std::less<key>, std::allocator<key>, fat_node_traits<16>>>("fat16", keys, probes);
+    run<jump_list<key, std::less<key>, std::allocator<key>, fat_node_traits<32>>>("fat32", keys, probes);
+    run<jump_list<key, std::less<key>, std::allocator<key>, compact_traits>>("compact", keys, probes);
+    return 0;
+}
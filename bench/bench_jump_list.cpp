@@ -0,0 +1,246 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+// Google Benchmark suite: jump_list against std::multiset and, when built
+// with Abseil, absl::btree_multiset, on int64_t keys from 1K to 100M
+// elements. Benchmarks are named <operation>/<container>/<elements>, so
+// e.g. --benchmark_filter='/(1000|1000000)$' picks sizes. The bench_json
+// target writes the whole run to bench_jump_list.json for tools/compare.py.
+
+#include "jump_list.h"
+
+#include <benchmark/benchmark.h>
+
+#if defined(JUMP_LIST_BENCH_ABSL)
+#include <absl/container/btree_set.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+using key = std::int64_t;
+using fat_jump_list = jump_list<key, std::less<key>, std::allocator<key>, fat_node_traits<16>>;
+
+constexpr std::size_t sizes[] = {1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000};
+constexpr std::size_t scan_length = 100;
+constexpr std::size_t probe_count = 1 << 20;
+
+// Keys are even, so odd values are guaranteed misses.
+std::vector<key> random_keys(std::size_t n, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<key> keys(n);
+    for (auto& k : keys) {
+        k = static_cast<key>(rng() >> 2) << 1;
+    }
+    return keys;
+}
+
+struct fixture_base {
+    virtual ~fixture_base() = default;
+};
+
+std::unique_ptr<fixture_base>& current_fixture() {
+    static std::unique_ptr<fixture_base> current;
+    return current;
+}
+
+// The container the lookup and scan benchmarks run against. main()
+// registers every operation for one (container, size) pair before moving
+// on, so each one is built once. It is dropped before the insert and erase
+// benchmarks, which build their own, so at most one large container is
+// alive at a time.
+template<typename C>
+struct fixture : fixture_base {
+    std::size_t n;
+    std::vector<key> keys;
+    std::vector<key> hits;
+    std::vector<key> misses;
+    C container;
+
+    explicit fixture(std::size_t size)
+        : n(size), keys(random_keys(size, 42)), hits(probe_count), misses(probe_count),
+          container(keys.begin(), keys.end()) {
+        std::mt19937_64 rng(7);
+        for (std::size_t i = 0; i < probe_count; ++i) {
+            hits[i] = keys[rng() % n];
+            misses[i] = keys[rng() % n] | 1;
+        }
+    }
+
+    static fixture& get(std::size_t size) {
+        auto& current = current_fixture();
+        auto* f = dynamic_cast<fixture*>(current.get());
+        if (!f || f->n != size) {
+            current.reset();
+            current = std::make_unique<fixture>(size);
+            f = static_cast<fixture*>(current.get());
+        }
+        return *f;
+    }
+};
+
+template<typename C>
+void insert_keys(benchmark::State& state, std::size_t n, bool sorted, bool reverse) {
+    current_fixture().reset();
+    std::vector<key> keys = random_keys(n, 42);
+    if (sorted) {
+        std::sort(keys.begin(), keys.end());
+    }
+    if (reverse) {
+        std::reverse(keys.begin(), keys.end());
+    }
+    for (auto _ : state) {
+        C c;
+        for (key k : keys) {
+            c.insert(k);
+        }
+        benchmark::DoNotOptimize(c);
+        state.PauseTiming();
+        c = C();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * n));
+}
+
+template<typename C>
+void find_keys(benchmark::State& state, std::size_t n, bool hit) {
+    auto& f = fixture<C>::get(n);
+    const auto& probes = hit ? f.hits : f.misses;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(f.container.find(probes[i++ & (probe_count - 1)]));
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+template<typename C>
+void bound_keys(benchmark::State& state, std::size_t n, bool upper) {
+    auto& f = fixture<C>::get(n);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        key probe = f.misses[i++ & (probe_count - 1)];
+        benchmark::DoNotOptimize(upper ? f.container.upper_bound(probe) : f.container.lower_bound(probe));
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+template<typename C>
+void erase_keys(benchmark::State& state, std::size_t n) {
+    current_fixture().reset();
+    std::vector<key> keys = random_keys(n, 42);
+    std::vector<key> order = keys;
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(3));
+    for (auto _ : state) {
+        state.PauseTiming();
+        C c(keys.begin(), keys.end());
+        state.ResumeTiming();
+        for (key k : order) {
+            c.erase(k);
+        }
+        benchmark::DoNotOptimize(c);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * n));
+}
+
+template<typename C>
+void iterate(benchmark::State& state, std::size_t n, bool reverse) {
+    auto& f = fixture<C>::get(n);
+    for (auto _ : state) {
+        key sum = 0;
+        if (reverse) {
+            for (auto it = f.container.rbegin(); it != f.container.rend(); ++it) {
+                sum += *it;
+            }
+        } else {
+            for (key k : f.container) {
+                sum += k;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * n));
+}
+
+template<typename C>
+void range_scan(benchmark::State& state, std::size_t n) {
+    auto& f = fixture<C>::get(n);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        auto it = f.container.lower_bound(f.misses[i++ & (probe_count - 1)]);
+        key sum = 0;
+        for (std::size_t j = 0; j < scan_length && it != f.container.end(); ++j, ++it) {
+            sum += *it;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * scan_length));
+}
+
+// Full scan through for_each_range(), which jump_list runs with prefetching
+// lookouts and the fat layout one node at a time.
+template<typename C>
+void scan_all(benchmark::State& state, std::size_t n) {
+    auto& f = fixture<C>::get(n);
+    for (auto _ : state) {
+        key sum = 0;
+        f.container.for_each_range(std::numeric_limits<key>::min(), std::numeric_limits<key>::max(),
+                                   [&](key k) { sum += k; });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * n));
+}
+
+template<typename C>
+void register_container(const std::string& name) {
+    for (std::size_t n : sizes) {
+        std::string suffix = "/" + name + "/" + std::to_string(n);
+        auto add = [&](const char* op, auto fn) {
+            return benchmark::RegisterBenchmark((op + suffix).c_str(), fn);
+        };
+        add("insert_random", [n](benchmark::State& s) { insert_keys<C>(s, n, false, false); })
+            ->Unit(benchmark::kMillisecond);
+        add("insert_sorted", [n](benchmark::State& s) { insert_keys<C>(s, n, true, false); })
+            ->Unit(benchmark::kMillisecond);
+        add("insert_reverse", [n](benchmark::State& s) { insert_keys<C>(s, n, true, true); })
+            ->Unit(benchmark::kMillisecond);
+        add("erase", [n](benchmark::State& s) { erase_keys<C>(s, n); })->Unit(benchmark::kMillisecond);
+        add("find_hit", [n](benchmark::State& s) { find_keys<C>(s, n, true); });
+        add("find_miss", [n](benchmark::State& s) { find_keys<C>(s, n, false); });
+        add("lower_bound", [n](benchmark::State& s) { bound_keys<C>(s, n, false); });
+        add("upper_bound", [n](benchmark::State& s) { bound_keys<C>(s, n, true); });
+        add("range_scan", [n](benchmark::State& s) { range_scan<C>(s, n); });
+        add("iterate", [n](benchmark::State& s) { iterate<C>(s, n, false); })->Unit(benchmark::kMillisecond);
+        add("iterate_reverse", [n](benchmark::State& s) { iterate<C>(s, n, true); })
+            ->Unit(benchmark::kMillisecond);
+        if constexpr (requires(const C& c) { c.for_each_range(key(), key(), [](key) {}); }) {
+            add("scan", [n](benchmark::State& s) { scan_all<C>(s, n); })->Unit(benchmark::kMillisecond);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    register_container<jump_list<key>>("jump_list");
+    register_container<fat_jump_list>("jump_list_fat16");
+    register_container<std::multiset<key>>("std_multiset");
+#if defined(JUMP_LIST_BENCH_ABSL)
+    register_container<absl::btree_multiset<key>>("absl_btree_multiset");
+#endif
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
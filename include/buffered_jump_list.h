@@ -0,0 +1,344 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+#ifndef BUFFERED_JUMP_LIST_H
+#define BUFFERED_JUMP_LIST_H
+
+#include "jump_list.h"
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Ordered multiset tuned for write bursts, in the manner of an LSM tree's
+// memtable. Inserts go into a sorted buffer of up to N elements (one
+// binary search and a short move, or a plain append for ascending keys)
+// instead of a skip-list search over the whole set. The insertion that
+// finds the buffer full first merges it into the main jump_list with
+// insert_sorted(): one walk along level 0 when the buffer is large next to
+// the list, otherwise one search per element, each resuming from the
+// previous insertion point.
+//
+// Lookups search both the list and the buffer, and iterators merge the
+// two on the fly; equivalent elements still come out in insertion order.
+// Inserting invalidates iterators, since it may flush the buffer.
+template<typename T, std::size_t N = 256, typename Compare = std::less<T>, typename Allocator = std::allocator<T>,
+         typename Traits = jump_list_traits>
+    requires jump_list_comparator<Compare, T> && (N > 0)
+class buffered_jump_list {
+    using list_type = jump_list<T, Compare, Allocator, Traits>;
+    using list_iterator = typename list_type::const_iterator;
+    using buffer_type = std::vector<T, Allocator>;
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+
+    static constexpr size_type buffer_capacity = N;
+
+    // A position in the list and one in the buffer; the element is the
+    // smaller of the two, the list's on ties, as it was inserted earlier.
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() noexcept = default;
+
+        reference operator*() const { return in_buffer() ? *p_ : *it_; }
+        pointer operator->() const { return in_buffer() ? p_ : std::addressof(*it_); }
+
+        const_iterator& operator++() {
+            if (in_buffer()) {
+                ++p_;
+            } else {
+                ++it_;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        // Steps back on whichever side holds the later element, the buffer
+        // on ties.
+        const_iterator& operator--() {
+            if (p_ != owner_->buffer_.data() &&
+                (it_ == owner_->list_.begin() || !owner_->comp_(p_[-1], *std::prev(it_)))) {
+                --p_;
+            } else {
+                --it_;
+            }
+            return *this;
+        }
+
+        const_iterator operator--(int) {
+            const_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept {
+            return a.it_ == b.it_ && a.p_ == b.p_;
+        }
+
+    private:
+        friend class buffered_jump_list;
+
+        const_iterator(const buffered_jump_list* owner, list_iterator it, const T* p) noexcept
+            : owner_(owner), it_(it), p_(p) {}
+
+        bool in_buffer() const {
+            return p_ != owner_->buffer_end() && (it_ == owner_->list_.end() || owner_->comp_(*p_, *it_));
+        }
+
+        const buffered_jump_list* owner_ = nullptr;
+        list_iterator it_;
+        const T* p_ = nullptr;
+    };
+
+    using iterator = const_iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // Construction and destruction
+
+    buffered_jump_list() : buffered_jump_list(Compare()) {}
+
+    explicit buffered_jump_list(const Compare& comp, const Allocator& alloc = Allocator())
+        : comp_(comp), list_(comp, alloc), buffer_(alloc) {}
+
+    explicit buffered_jump_list(const Allocator& alloc) : buffered_jump_list(Compare(), alloc) {}
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    buffered_jump_list(It first, It last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : comp_(comp), list_(first, last, comp, alloc), buffer_(alloc) {}
+
+    buffered_jump_list(std::initializer_list<T> init, const Compare& comp = Compare(),
+                       const Allocator& alloc = Allocator())
+        : buffered_jump_list(init.begin(), init.end(), comp, alloc) {}
+
+    allocator_type get_allocator() const noexcept { return list_.get_allocator(); }
+
+    // Iterators
+
+    iterator begin() const noexcept { return iterator(this, list_.begin(), buffer_.data()); }
+    iterator end() const noexcept { return iterator(this, list_.end(), buffer_end()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    reverse_iterator rbegin() const noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() const noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    size_type size() const noexcept { return list_.size() + buffer_.size(); }
+
+    // Elements waiting in the buffer.
+    size_type buffered() const noexcept { return buffer_.size(); }
+
+    // Modifiers
+
+    void clear() noexcept {
+        list_.clear();
+        buffer_.clear();
+    }
+
+    // Returns no iterator: finding the element's place in the list is the
+    // search that buffering defers.
+    void insert(const T& value) { emplace(value); }
+    void insert(T&& value) { emplace(std::move(value)); }
+
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    void emplace(Args&&... args) {
+        // Built before flushing, as args may refer to a buffered element.
+        T v(std::forward<Args>(args)...);
+        if (buffer_.size() == N) {
+            flush();
+        }
+        if (buffer_.capacity() < N) {
+            buffer_.reserve(N);
+        }
+        auto pos = buffer_.empty() || !comp_(v, buffer_.back())
+                       ? buffer_.end()
+                       : std::upper_bound(buffer_.begin(), buffer_.end(), v, comp_);
+        buffer_.insert(pos, std::move(v));
+    }
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    void insert(It first, It last) {
+        for (; first != last; ++first) {
+            emplace(*first);
+        }
+    }
+
+    void insert(std::initializer_list<T> init) { insert(init.begin(), init.end()); }
+
+    // Merges the buffer into the list. If that throws, the elements that
+    // reached the list have left the buffer and the rest are still in it.
+    void flush() {
+        size_type before = list_.size();
+        try {
+            if constexpr (std::is_nothrow_move_constructible_v<T>) {
+                // Not move_iterator, which would make the range input-only
+                // and force the walk along level 0.
+                list_.insert_sorted(buffer_ | std::views::transform([](T& v) -> T&& { return std::move(v); }));
+            } else {
+                list_.insert_sorted(buffer_);
+            }
+        } catch (...) {
+            buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<difference_type>(list_.size() - before));
+            throw;
+        }
+        buffer_.clear();
+    }
+
+    iterator erase(const_iterator pos) {
+        if (pos.in_buffer()) {
+            auto i = pos.p_ - buffer_.data();
+            buffer_.erase(buffer_.begin() + i);
+            return iterator(this, pos.it_, buffer_.data() + i);
+        }
+        return iterator(this, list_.erase(pos.it_), pos.p_);
+    }
+
+    size_type erase(const T& key) {
+        auto [first, last] = std::equal_range(buffer_.begin(), buffer_.end(), key, comp_);
+        auto n = static_cast<size_type>(last - first);
+        buffer_.erase(first, last);
+        return n + list_.erase(key);
+    }
+
+    void swap(buffered_jump_list& other) noexcept(std::is_nothrow_swappable_v<Compare>) {
+        using std::swap;
+        swap(comp_, other.comp_);
+        list_.swap(other.list_);
+        buffer_.swap(other.buffer_);
+    }
+
+    friend void swap(buffered_jump_list& a, buffered_jump_list& b) noexcept(noexcept(a.swap(b))) { a.swap(b); }
+
+    // Lookup
+
+    size_type count(const T& key) const { return count_key(key); }
+
+    iterator find(const T& key) const { return find_at(key); }
+
+    bool contains(const T& key) const { return find(key) != end(); }
+
+    iterator lower_bound(const T& key) const { return bound_at<false>(key); }
+    iterator upper_bound(const T& key) const { return bound_at<true>(key); }
+
+    std::pair<iterator, iterator> equal_range(const T& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // Heterogeneous lookup for transparent comparators, as in jump_list.
+
+    template<jump_list_lookup_key<Compare, T> K>
+    size_type count(const K& key) const {
+        return count_key(key);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator find(const K& key) const {
+        return find_at(key);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    bool contains(const K& key) const {
+        return find(key) != end();
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator lower_bound(const K& key) const {
+        return bound_at<false>(key);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator upper_bound(const K& key) const {
+        return bound_at<true>(key);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    std::pair<iterator, iterator> equal_range(const K& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // Observers
+
+    key_compare key_comp() const { return comp_; }
+    value_compare value_comp() const { return comp_; }
+
+    // Comparison
+
+    friend bool operator==(const buffered_jump_list& a, const buffered_jump_list& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    friend auto operator<=>(const buffered_jump_list& a, const buffered_jump_list& b) {
+        return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end(),
+                                                      jl_detail::synth_three_way{});
+    }
+
+private:
+    const T* buffer_end() const noexcept { return buffer_.data() + buffer_.size(); }
+
+    // K is T or a transparent lookup key.
+    template<bool Upper, typename K>
+    iterator bound_at(const K& key) const {
+        if constexpr (Upper) {
+            return iterator(this, list_.upper_bound(key),
+                            std::upper_bound(buffer_.data(), buffer_end(), key, comp_));
+        } else {
+            return iterator(this, list_.lower_bound(key),
+                            std::lower_bound(buffer_.data(), buffer_end(), key, comp_));
+        }
+    }
+
+    template<typename K>
+    iterator find_at(const K& key) const {
+        iterator it = bound_at<false>(key);
+        return it != end() && !comp_(key, *it) ? it : end();
+    }
+
+    template<typename K>
+    size_type count_key(const K& key) const {
+        auto [first, last] = std::equal_range(buffer_.data(), buffer_end(), key, comp_);
+        return static_cast<size_type>(last - first) + list_.count(key);
+    }
+
+    [[no_unique_address]] Compare comp_;
+    list_type list_;
+    // Sorted; equivalent elements in insertion order.
+    buffer_type buffer_;
+};
+
+#endif // BUFFERED_JUMP_LIST_H
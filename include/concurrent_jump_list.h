@@ -0,0 +1,709 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+#ifndef CONCURRENT_JUMP_LIST_H
+#define CONCURRENT_JUMP_LIST_H
+
+#include "epoch_reclamation.h"
+#include "jump_list.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Lock-free ordered set in the style of Herlihy and Shavit's LockFreeSkipList.
+// Every forward link carries a mark bit in its lowest bit; setting the mark
+// on a node's own links deletes it logically, and searches physically unlink
+// marked nodes as they pass. Unlike jump_list, keys are unique. Unlinked
+// nodes are reclaimed through epoch_domain, so every member except the
+// destructor may be called from any number of threads without locking.
+//
+// snapshot() gives a read-only view of the set as of one moment (MVCC).
+// Every node carries the version at which it was inserted and the one at
+// which it was erased, both drawn from a shared clock. erase() stamps the
+// node, which current readers then skip, and marks and unlinks it as usual
+// unless a live snapshot may still see it; such nodes stay linked until the
+// last snapshot that needs them is released, which reclaims them.
+template<typename T, typename Compare = std::less<T>>
+    requires jump_list_comparator<Compare, T>
+class concurrent_jump_list {
+    using link = std::atomic<std::uintptr_t>;
+
+    // Like jump_list nodes, one allocation: the value, then the tower.
+    // owners starts at 2, one share for the list and one for the inserting
+    // thread, which may still be linking upper levels while another thread
+    // erases the node. Whoever drops the last share retires the node.
+    // inserted and erased are versions, pending until someone draws one
+    // from the clock; erased stays alive_stamp until the node is erased.
+    struct alignas(link) node {
+        union {
+            T value;
+        };
+        int height;
+        std::atomic<int> owners;
+        std::atomic<std::uint64_t> inserted;
+        std::atomic<std::uint64_t> erased;
+
+        node() noexcept {}
+        ~node() {}
+
+        link& next(int i) noexcept { return reinterpret_cast<link*>(this + 1)[i]; }
+    };
+
+    static constexpr int max_level = jl_detail::max_level;
+    static constexpr std::uintptr_t mark_bit = 1;
+    static constexpr std::uint64_t alive_stamp = ~std::uint64_t{0};
+    static constexpr std::uint64_t pending_stamp = alive_stamp - 1;
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+
+    // Forward iterator over level 0 that skips logically deleted nodes. It
+    // keeps its thread pinned, so the node it points at and everything
+    // reachable from it stays allocated even if erased meanwhile; a scan
+    // never locks and never reads freed memory. Elements erased or inserted
+    // during the scan may or may not be seen. Like epoch_guard, an iterator
+    // must stay on the thread that created it, and a long-lived one delays
+    // reclamation for all threads.
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() noexcept : guard_(nullptr) {}
+
+        reference operator*() const noexcept { return node_->value; }
+        pointer operator->() const noexcept { return std::addressof(node_->value); }
+
+        const_iterator& operator++() noexcept {
+            node_ = first_live(pointer_of(node_->next(0).load(std::memory_order_acquire)));
+            if (!node_) {
+                guard_.reset();
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept {
+            return a.node_ == b.node_;
+        }
+
+    private:
+        friend class concurrent_jump_list;
+
+        const_iterator(epoch_guard&& guard, node* n) noexcept : guard_(std::move(guard)), node_(n) {
+            if (!node_) {
+                guard_.reset();
+            }
+        }
+
+        epoch_guard guard_;
+        node* node_ = nullptr;
+    };
+
+    using iterator = const_iterator;
+
+private:
+    // Registers one live snapshot: version holds a lower bound on its
+    // version, alive_stamp while the slot is free. Slots are reused, as
+    // epoch_domain reuses thread records, and freed with the list; each has
+    // a cache line of its own, so views on different threads do not share
+    // one.
+    struct alignas(64) snapshot_slot {
+        std::atomic<std::uint64_t> version{alive_stamp};
+        std::atomic<bool> in_use{true};
+        snapshot_slot* next = nullptr;
+    };
+
+public:
+    // Read-only view of the elements present when snapshot() was called,
+    // unaffected by later inserts and erasures. Creating one claims a slot
+    // and reads the clock, without a lock or a copy. The view may be
+    // moved to and read from any thread, while its iterators pin their
+    // thread like const_iterator does. A live view keeps the nodes it can
+    // see linked, so it should not be held longer than needed; it must not
+    // outlive the list.
+    class snapshot_view {
+    public:
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            const_iterator() noexcept : guard_(nullptr) {}
+
+            reference operator*() const noexcept { return node_->value; }
+            pointer operator->() const noexcept { return std::addressof(node_->value); }
+
+            const_iterator& operator++() {
+                node_ = list_->first_visible(pointer_of(node_->next(0).load(std::memory_order_acquire)), version_);
+                if (!node_) {
+                    guard_.reset();
+                }
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept {
+                return a.node_ == b.node_;
+            }
+
+        private:
+            friend class snapshot_view;
+
+            const_iterator(epoch_guard&& guard, const concurrent_jump_list* list, std::uint64_t version, node* n)
+                : guard_(std::move(guard)), list_(list), version_(version), node_(n) {
+                if (!node_) {
+                    guard_.reset();
+                }
+            }
+
+            epoch_guard guard_;
+            const concurrent_jump_list* list_ = nullptr;
+            std::uint64_t version_ = 0;
+            node* node_ = nullptr;
+        };
+
+        using iterator = const_iterator;
+
+        snapshot_view(snapshot_view&& other) noexcept
+            : list_(std::exchange(other.list_, nullptr)), slot_(other.slot_), version_(other.version_) {}
+
+        snapshot_view& operator=(snapshot_view other) noexcept {
+            std::swap(list_, other.list_);
+            std::swap(slot_, other.slot_);
+            std::swap(version_, other.version_);
+            return *this;
+        }
+
+        ~snapshot_view() {
+            if (list_) {
+                list_->unregister_snapshot(slot_);
+            }
+        }
+
+        const_iterator begin() const {
+            epoch_guard guard;
+            node* n = list_->first_visible(pointer_of(list_->head()->next(0).load(std::memory_order_acquire)),
+                                           version_);
+            return const_iterator(std::move(guard), list_, version_, n);
+        }
+
+        const_iterator end() const noexcept { return const_iterator(); }
+
+        const_iterator lower_bound(const T& key) const {
+            epoch_guard guard;
+            node* n = list_->first_visible(list_->seek(key), version_);
+            return const_iterator(std::move(guard), list_, version_, n);
+        }
+
+        bool contains(const T& key) const {
+            epoch_guard guard;
+            node* n = list_->first_visible(list_->seek(key), version_);
+            return n && !list_->comp_(key, n->value);
+        }
+
+        std::optional<T> find(const T& key) const {
+            epoch_guard guard;
+            node* n = list_->first_visible(list_->seek(key), version_);
+            return n && !list_->comp_(key, n->value) ? std::optional<T>(n->value) : std::nullopt;
+        }
+
+        // Clock reading the view was taken at.
+        std::uint64_t version() const noexcept { return version_; }
+
+    private:
+        friend class concurrent_jump_list;
+
+        snapshot_view(const concurrent_jump_list* list, snapshot_slot* slot, std::uint64_t version) noexcept
+            : list_(list), slot_(slot), version_(version) {}
+
+        const concurrent_jump_list* list_;
+        snapshot_slot* slot_;
+        std::uint64_t version_;
+    };
+
+    concurrent_jump_list() : concurrent_jump_list(Compare()) {}
+
+    explicit concurrent_jump_list(const Compare& comp) : comp_(comp) {
+        node* h = ::new (static_cast<void*>(head_storage_)) node;
+        h->height = max_level;
+        for (int i = 0; i < max_level; ++i) {
+            ::new (static_cast<void*>(&h->next(i))) link(0);
+        }
+    }
+
+    concurrent_jump_list(std::initializer_list<T> init, const Compare& comp = Compare())
+        : concurrent_jump_list(comp) {
+        for (const T& value : init) {
+            insert(value);
+        }
+    }
+
+    concurrent_jump_list(const concurrent_jump_list&) = delete;
+    concurrent_jump_list& operator=(const concurrent_jump_list&) = delete;
+
+    // Not thread-safe: no other thread may use the list any more. Nodes that
+    // were erased earlier are owned by the epoch domain and freed there.
+    ~concurrent_jump_list() {
+        node* n = pointer_of(head()->next(0).load(std::memory_order_acquire));
+        while (n) {
+            node* next = pointer_of(n->next(0).load(std::memory_order_relaxed));
+            destroy(n);
+            n = next;
+        }
+        for (snapshot_slot* slot = slots_.load(std::memory_order_acquire); slot;) {
+            delete std::exchange(slot, slot->next);
+        }
+    }
+
+    // Inserts value unless an equivalent key is present. Lock-free; the
+    // linearization point is the CAS that links the node on level 0.
+    bool insert(const T& value) { return insert_node(value); }
+    bool insert(T&& value) { return insert_node(std::move(value)); }
+
+    // Erases the element equivalent to key by stamping it with a new
+    // version, then marks and unlinks it unless a live snapshot can still
+    // see it. Returns false if no such element was present.
+    bool erase(const T& key) {
+        epoch_guard guard;
+        node* preds[max_level];
+        node* succs[max_level];
+        node* victim = find_preds(key, preds, succs);
+        if (!victim) {
+            return false;
+        }
+        // The insertion gets its version first, so it is older than the
+        // erasure.
+        resolve(victim->inserted);
+        std::uint64_t expected = alive_stamp;
+        if (!victim->erased.compare_exchange_strong(expected, pending_stamp)) {
+            return false;
+        }
+        resolve(victim->erased);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        if (!reclaimable(victim)) {
+            std::lock_guard lock(deferred_mutex_);
+            // Counted before the second look at the slots; a view released
+            // in between sees the count and comes for the node.
+            deferred_count_.fetch_add(1);
+            if (!reclaimable(victim)) {
+                deferred_.push_back(victim);
+                return true;
+            }
+            deferred_count_.fetch_sub(1);
+        }
+        reclaim(victim, preds, succs);
+        return true;
+    }
+
+    bool contains(const T& key) const {
+        epoch_guard guard;
+        return find_node(key) != nullptr;
+    }
+
+    // Returns a copy of the stored element equivalent to key, if any.
+    std::optional<T> find(const T& key) const {
+        epoch_guard guard;
+        node* n = find_node(key);
+        return n ? std::optional<T>(n->value) : std::nullopt;
+    }
+
+    const_iterator begin() const {
+        epoch_guard guard;
+        node* n = first_live(pointer_of(head()->next(0).load(std::memory_order_acquire)));
+        return const_iterator(std::move(guard), n);
+    }
+
+    const_iterator end() const noexcept { return const_iterator(); }
+
+    // First element not less than key; starts a range scan.
+    const_iterator lower_bound(const T& key) const {
+        epoch_guard guard;
+        node* n = lower_bound_node(key);
+        return const_iterator(std::move(guard), n);
+    }
+
+    // Lock-free and independent of the size of the list: it reuses a free
+    // slot, found among as many as were ever live at once, and reads the
+    // clock.
+    snapshot_view snapshot() const {
+        snapshot_slot* slot = acquire_slot();
+        // The slot is published before the version is read: an erasure
+        // stamped after that read then finds the slot and leaves its node
+        // linked for this view. Raising the slot to the version afterwards
+        // only lets go of nodes erased in between, which the view does not
+        // see.
+        slot->version.store(clock_.load());
+        std::uint64_t version = clock_.load();
+        slot->version.store(version);
+        return snapshot_view(this, slot, version);
+    }
+
+    // Exact when the list is quiescent, approximate while it is modified.
+    size_type size() const noexcept { return size_.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+    key_compare key_comp() const { return comp_; }
+    value_compare value_comp() const { return comp_; }
+
+private:
+    static node* pointer_of(std::uintptr_t v) noexcept { return reinterpret_cast<node*>(v & ~mark_bit); }
+    static bool marked(std::uintptr_t v) noexcept { return (v & mark_bit) != 0; }
+    static std::uintptr_t word(node* n) noexcept { return reinterpret_cast<std::uintptr_t>(n); }
+
+    node* head() const noexcept {
+        return std::launder(reinterpret_cast<node*>(const_cast<unsigned char*>(head_storage_)));
+    }
+
+    static std::size_t node_size(int height) noexcept { return sizeof(node) + height * sizeof(link); }
+
+    // Per-thread xorshift generator; the coin flips of all threads are
+    // independent and need no synchronization.
+    static int random_level() noexcept {
+        thread_local std::uint64_t state =
+            std::hash<std::thread::id>{}(std::this_thread::get_id()) * 0x9E3779B97F4A7C15ull | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return std::min(std::countr_zero(state | (std::uint64_t{1} << (max_level - 1))) + 1, max_level);
+    }
+
+    template<typename V>
+    static node* create(int height, V&& value) {
+        void* raw = ::operator new(node_size(height), std::align_val_t(alignof(node)));
+        node* n = ::new (raw) node;
+        try {
+            ::new (static_cast<void*>(std::addressof(n->value))) T(std::forward<V>(value));
+        } catch (...) {
+            ::operator delete(raw, std::align_val_t(alignof(node)));
+            throw;
+        }
+        n->height = height;
+        n->owners.store(2, std::memory_order_relaxed);
+        n->inserted.store(pending_stamp, std::memory_order_relaxed);
+        n->erased.store(alive_stamp, std::memory_order_relaxed);
+        for (int i = 0; i < height; ++i) {
+            ::new (static_cast<void*>(&n->next(i))) link(0);
+        }
+        return n;
+    }
+
+    static void destroy(node* n) noexcept {
+        n->value.~T();
+        n->~node();
+        ::operator delete(static_cast<void*>(n), std::align_val_t(alignof(node)));
+    }
+
+    static void destroy_erased(void* p) noexcept { destroy(static_cast<node*>(p)); }
+
+    static void release(node* n) {
+        if (n->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            epoch_domain::global().retire(n, &destroy_erased);
+        }
+    }
+
+    // Value of a version stamp, drawing a fresh version from the clock if it
+    // is still pending. Any thread may do this for the owner, so the first
+    // reader to need the value fixes it: a pending insertion is newer than
+    // every snapshot taken before it was resolved, a pending erasure older
+    // than none of them.
+    std::uint64_t resolve(std::atomic<std::uint64_t>& stamp) const {
+        std::uint64_t v = stamp.load();
+        if (v == pending_stamp) {
+            std::uint64_t fresh = clock_.fetch_add(1) + 1;
+            if (stamp.compare_exchange_strong(v, fresh)) {
+                v = fresh;
+            }
+        }
+        return v;
+    }
+
+    static bool erased(node* n) noexcept { return n->erased.load(std::memory_order_acquire) != alive_stamp; }
+
+    // Inserted at or before version and not erased by then.
+    bool visible(node* n, std::uint64_t version) const {
+        if (resolve(n->inserted) > version) {
+            return false;
+        }
+        return !erased(n) || version < resolve(n->erased);
+    }
+
+    // Erased before every live snapshot was taken.
+    bool reclaimable(node* n) const { return erased(n) && resolve(n->erased) <= horizon(); }
+
+    // Lowest version a live snapshot may hold, alive_stamp while there are
+    // none. Computed when an erasure asks, so snapshots never update a
+    // shared minimum; a slot read before its snapshot publishes it belongs
+    // to a view whose version is newer than the erasure.
+    std::uint64_t horizon() const {
+        std::uint64_t h = alive_stamp;
+        for (snapshot_slot* slot = slots_.load(std::memory_order_acquire); slot; slot = slot->next) {
+            h = std::min(h, slot->version.load());
+        }
+        return h;
+    }
+
+    snapshot_slot* acquire_slot() const {
+        for (snapshot_slot* slot = slots_.load(std::memory_order_acquire); slot; slot = slot->next) {
+            bool expected = false;
+            if (!slot->in_use.load(std::memory_order_relaxed) &&
+                slot->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return slot;
+            }
+        }
+        auto* slot = new snapshot_slot;
+        slot->next = slots_.load(std::memory_order_relaxed);
+        while (!slots_.compare_exchange_weak(slot->next, slot, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+        }
+        return slot;
+    }
+
+    // Marks the links of an erased node top down and returns whether this
+    // thread's mark on level 0 landed.
+    static bool purge(node* n) {
+        for (int i = n->height - 1; i >= 1; --i) {
+            std::uintptr_t v = n->next(i).load(std::memory_order_acquire);
+            while (!marked(v) && !n->next(i).compare_exchange_weak(v, v | mark_bit, std::memory_order_acq_rel)) {
+            }
+        }
+        std::uintptr_t v = n->next(0).load(std::memory_order_acquire);
+        while (!marked(v)) {
+            if (n->next(0).compare_exchange_weak(v, v | mark_bit, std::memory_order_acq_rel)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Marks n, an erased node no snapshot needs, and unlinks it with a
+    // search for its key, which passes it on every level; only then may the
+    // list's share go. Caller must be pinned.
+    void reclaim(node* n, node** preds, node** succs) const {
+        bool owner = purge(n);
+        find_preds(n->value, preds, succs);
+        if (owner) {
+            release(n);
+        }
+    }
+
+    // Frees a snapshot's slot and reclaims the erased nodes that only it
+    // still held back.
+    void unregister_snapshot(snapshot_slot* slot) const {
+        slot->version.store(alive_stamp);
+        slot->in_use.store(false, std::memory_order_release);
+        if (deferred_count_.load() == 0) {
+            return;
+        }
+        std::vector<node*> ready;
+        {
+            std::lock_guard lock(deferred_mutex_);
+            auto keep = std::partition(deferred_.begin(), deferred_.end(),
+                                       [this](node* n) { return !reclaimable(n); });
+            ready.assign(keep, deferred_.end());
+            deferred_.erase(keep, deferred_.end());
+            deferred_count_.store(deferred_.size());
+        }
+        epoch_guard guard;
+        node* preds[max_level];
+        node* succs[max_level];
+        for (node* n : ready) {
+            reclaim(n, preds, succs);
+        }
+    }
+
+    // Fills preds/succs with the neighbours of key on every level below
+    // top_, unlinking any marked node met on the way, and returns the node
+    // equivalent to key that is not erased, if any. Erased equivalents are
+    // passed over, so a new node goes after them. top_ is raised before a
+    // node is linked, so it always covers the tower of a node the caller has
+    // seen or is inserting. Caller must be pinned.
+    node* find_preds(const T& key, node** preds, node** succs) const {
+    retry:
+        node* pred = head();
+        for (int i = top_.load(std::memory_order_relaxed) - 1; i >= 0; --i) {
+            node* curr = pointer_of(pred->next(i).load(std::memory_order_acquire));
+            while (curr) {
+                std::uintptr_t succ = curr->next(i).load(std::memory_order_acquire);
+                while (marked(succ)) {
+                    std::uintptr_t expected = word(curr);
+                    if (!pred->next(i).compare_exchange_strong(expected, succ & ~mark_bit,
+                                                               std::memory_order_acq_rel)) {
+                        goto retry;
+                    }
+                    curr = pointer_of(succ);
+                    if (!curr) {
+                        break;
+                    }
+                    succ = curr->next(i).load(std::memory_order_acquire);
+                }
+                if (!curr) {
+                    break;
+                }
+                if (!comp_(curr->value, key) && (!erased(curr) || comp_(key, curr->value))) {
+                    break;
+                }
+                pred = curr;
+                curr = pointer_of(succ);
+            }
+            preds[i] = pred;
+            succs[i] = curr;
+        }
+        node* n = succs[0];
+        return n && !comp_(key, n->value) ? n : nullptr;
+    }
+
+    // First node at or after n on level 0 that is neither marked nor erased.
+    static node* first_live(node* n) noexcept {
+        while (n) {
+            std::uintptr_t succ = n->next(0).load(std::memory_order_acquire);
+            if (!marked(succ) && !erased(n)) {
+                return n;
+            }
+            n = pointer_of(succ);
+        }
+        return nullptr;
+    }
+
+    // First node at or after n on level 0 that the snapshot at version sees.
+    // Such nodes are never marked while the snapshot lives.
+    node* first_visible(node* n, std::uint64_t version) const {
+        while (n && !visible(n, version)) {
+            n = pointer_of(n->next(0).load(std::memory_order_acquire));
+        }
+        return n;
+    }
+
+    node* find_node(const T& key) const {
+        node* n = lower_bound_node(key);
+        return n && !comp_(key, n->value) ? n : nullptr;
+    }
+
+    node* lower_bound_node(const T& key) const { return first_live(seek(key)); }
+
+    // Read-only search: steps over marked nodes instead of unlinking them
+    // and returns the first node on level 0 reached at or after key, which
+    // may be marked or erased.
+    node* seek(const T& key) const {
+        node* pred = head();
+        node* curr = nullptr;
+        for (int i = top_.load(std::memory_order_relaxed) - 1; i >= 0; --i) {
+            curr = pointer_of(pred->next(i).load(std::memory_order_acquire));
+            while (curr) {
+                std::uintptr_t succ = curr->next(i).load(std::memory_order_acquire);
+                while (marked(succ) && (curr = pointer_of(succ))) {
+                    succ = curr->next(i).load(std::memory_order_acquire);
+                }
+                if (!curr || !comp_(curr->value, key)) {
+                    break;
+                }
+                pred = curr;
+                curr = pointer_of(succ);
+            }
+        }
+        return curr;
+    }
+
+    template<typename V>
+    bool insert_node(V&& value) {
+        epoch_guard guard;
+        int height = random_level();
+        for (int top = top_.load(std::memory_order_relaxed);
+             top < height && !top_.compare_exchange_weak(top, height, std::memory_order_relaxed);) {
+        }
+        node* n = create(height, std::forward<V>(value));
+        node* preds[max_level];
+        node* succs[max_level];
+        while (true) {
+            if (find_preds(n->value, preds, succs)) {
+                destroy(n);
+                return false;
+            }
+            for (int i = 0; i < height; ++i) {
+                n->next(i).store(word(succs[i]), std::memory_order_relaxed);
+            }
+            std::uintptr_t expected = word(succs[0]);
+            if (preds[0]->next(0).compare_exchange_strong(expected, word(n), std::memory_order_acq_rel)) {
+                break;
+            }
+        }
+        resolve(n->inserted);
+        size_.fetch_add(1, std::memory_order_relaxed);
+        link_upper_levels(n, preds, succs);
+        release(n);
+        return true;
+    }
+
+    // Links n on levels [1, height). Stops as soon as n's own link on a
+    // level is marked, i.e. an eraser got to it; if that happens after n was
+    // linked somewhere, one more search makes sure it is unlinked again
+    // before the inserter drops its share.
+    void link_upper_levels(node* n, node** preds, node** succs) {
+        for (int i = 1; i < n->height; ++i) {
+            while (true) {
+                std::uintptr_t own = n->next(i).load(std::memory_order_acquire);
+                if (marked(own)) {
+                    find_preds(n->value, preds, succs);
+                    return;
+                }
+                if (pointer_of(own) != succs[i] &&
+                    !n->next(i).compare_exchange_strong(own, word(succs[i]), std::memory_order_acq_rel)) {
+                    continue;
+                }
+                std::uintptr_t expected = word(succs[i]);
+                if (preds[i]->next(i).compare_exchange_strong(expected, word(n), std::memory_order_acq_rel)) {
+                    break;
+                }
+                if (find_preds(n->value, preds, succs) != n) {
+                    return;
+                }
+            }
+        }
+        if (marked(n->next(n->height - 1).load(std::memory_order_acquire))) {
+            find_preds(n->value, preds, succs);
+        }
+    }
+
+    [[no_unique_address]] Compare comp_;
+    alignas(node) unsigned char head_storage_[sizeof(node) + max_level * sizeof(link)];
+    std::atomic<int> top_{1};
+    std::atomic<size_type> size_{0};
+    // Version clock. A snapshot at version v sees the nodes inserted at or
+    // before v and not erased by then.
+    mutable std::atomic<std::uint64_t> clock_{0};
+    // Slots of the live snapshots and of the free ones.
+    mutable std::atomic<snapshot_slot*> slots_{nullptr};
+    // Erased nodes a live snapshot may still see, and their number, which
+    // released views read without the lock. They stay linked until the
+    // snapshots holding them back are gone.
+    mutable std::mutex deferred_mutex_;
+    mutable std::vector<node*> deferred_;
+    mutable std::atomic<std::size_t> deferred_count_{0};
+};
+
+#endif // CONCURRENT_JUMP_LIST_H
@@ -0,0 +1,248 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+#ifndef EPOCH_RECLAMATION_H
+#define EPOCH_RECLAMATION_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Epoch-based memory reclamation (Fraser's EBR).
+//
+// A reader pins the global epoch with an epoch_guard for as long as it holds
+// pointers into a shared structure. A writer that unlinks an object retires
+// it instead of freeing it; the object goes into the retiring thread's limbo
+// bag for the current epoch. The global epoch advances only when every pinned
+// thread has observed the current value, so once it has moved two steps past
+// a bag's epoch nobody can still reach the objects in it and the whole bag is
+// freed at once.
+//
+// Pinning costs one store and a fence. A thread that stays pinned (a long
+// scan, a live iterator) holds back reclamation for everyone, never safety.
+// Guards belong to the thread that created them and must be destroyed there.
+class epoch_domain {
+public:
+    using deleter_type = void (*)(void*);
+
+    // The process-wide domain shared by concurrent_jump_list and friends.
+    // It is never destroyed: thread_local destructors that run during exit,
+    // in whatever order, may still collect into it. Whatever is still
+    // retired at exit is left to the operating system.
+    static epoch_domain& global() {
+        static epoch_domain* domain = new epoch_domain;
+        return *domain;
+    }
+
+    epoch_domain(const epoch_domain&) = delete;
+    epoch_domain& operator=(const epoch_domain&) = delete;
+
+    // Hands p to the domain once it is unreachable for threads that pin
+    // from now on. The caller must be pinned.
+    void retire(void* p, deleter_type deleter) {
+        record& r = local();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::uint64_t e = global_.load(std::memory_order_relaxed);
+        limbo_bag& bag = r.bags[e % r.bags.size()];
+        if (bag.epoch != e) {
+            // The bag last held objects from epoch e - 3 or earlier.
+            free_bag(bag);
+            bag.epoch = e;
+        }
+        bag.items.push_back({p, deleter});
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        if (++r.retired_since_collect >= collect_threshold) {
+            collect(r);
+        }
+    }
+
+    template<typename T>
+    void retire(T* p) {
+        retire(p, [](void* q) { delete static_cast<T*>(q); });
+    }
+
+    // Tries to advance the epoch and frees this thread's expired bags.
+    void collect() { collect(local()); }
+
+    // Blocks until everything this thread retired before the call has been
+    // freed. Must not be called while pinned.
+    void synchronize() {
+        std::uint64_t target = global_.load(std::memory_order_acquire) + 2;
+        while (global_.load(std::memory_order_acquire) < target) {
+            if (!try_advance()) {
+                std::this_thread::yield();
+            }
+        }
+        record& r = local();
+        for (auto& bag : r.bags) {
+            free_bag(bag);
+        }
+    }
+
+    std::uint64_t epoch() const noexcept { return global_.load(std::memory_order_relaxed); }
+
+    // Objects retired by any thread and not freed yet.
+    std::size_t pending() const noexcept { return pending_.load(std::memory_order_relaxed); }
+
+    bool is_pinned() { return local().nesting != 0; }
+
+private:
+    static constexpr std::size_t collect_threshold = 64;
+
+    struct retired {
+        void* ptr;
+        deleter_type deleter;
+    };
+
+    struct limbo_bag {
+        std::uint64_t epoch = 0;
+        std::vector<retired> items;
+    };
+
+    // Per-thread state. The epoch word is 0 while the thread is quiescent
+    // and 2 * epoch + 1 while it is pinned. Records live as long as the
+    // domain; a thread that exits hands its record, limbo bags included, to
+    // the next thread that registers.
+    struct record {
+        std::atomic<std::uint64_t> epoch{0};
+        std::atomic<bool> in_use{true};
+        unsigned nesting = 0;
+        std::size_t retired_since_collect = 0;
+        std::array<limbo_bag, 3> bags;
+        record* next = nullptr;
+    };
+
+    struct thread_handle {
+        record* rec = nullptr;
+
+        ~thread_handle() {
+            if (rec) {
+                global().collect(*rec);
+                rec->in_use.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    friend class epoch_guard;
+
+    epoch_domain() = default;
+
+    record& local() {
+        thread_local thread_handle handle;
+        if (!handle.rec) {
+            handle.rec = acquire_record();
+        }
+        return *handle.rec;
+    }
+
+    record* acquire_record() {
+        for (record* r = records_.load(std::memory_order_acquire); r; r = r->next) {
+            bool expected = false;
+            if (!r->in_use.load(std::memory_order_relaxed) &&
+                r->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return r;
+            }
+        }
+        record* r = new record;
+        r->next = records_.load(std::memory_order_relaxed);
+        while (!records_.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return r;
+    }
+
+    void pin(record& r) {
+        if (r.nesting++ == 0) {
+            std::uint64_t e = global_.load(std::memory_order_relaxed);
+            r.epoch.store(2 * e + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void unpin(record& r) {
+        if (--r.nesting == 0) {
+            r.epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    // The global epoch moves on only when every pinned thread has observed
+    // the current one. Returns true if it has moved past the value read on
+    // entry, by this thread or another.
+    bool try_advance() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::uint64_t e = global_.load(std::memory_order_relaxed);
+        for (record* r = records_.load(std::memory_order_acquire); r; r = r->next) {
+            std::uint64_t v = r->epoch.load(std::memory_order_acquire);
+            if (v != 0 && v != 2 * e + 1) {
+                return false;
+            }
+        }
+        global_.compare_exchange_strong(e, e + 1, std::memory_order_acq_rel);
+        return true;
+    }
+
+    void collect(record& r) {
+        r.retired_since_collect = 0;
+        try_advance();
+        std::uint64_t e = global_.load(std::memory_order_acquire);
+        for (auto& bag : r.bags) {
+            if (!bag.items.empty() && bag.epoch + 2 <= e) {
+                free_bag(bag);
+            }
+        }
+    }
+
+    void free_bag(limbo_bag& bag) noexcept {
+        for (auto& item : bag.items) {
+            item.deleter(item.ptr);
+        }
+        pending_.fetch_sub(bag.items.size(), std::memory_order_relaxed);
+        bag.items.clear();
+    }
+
+    std::atomic<std::uint64_t> global_{0};
+    std::atomic<record*> records_{nullptr};
+    std::atomic<std::size_t> pending_{0};
+};
+
+// Pins the global epoch domain for its lifetime. Guards nest on a thread;
+// only the outermost one publishes the epoch. A guard built from nullptr or
+// moved from pins nothing; copying a pinning guard pins the current thread.
+class epoch_guard {
+public:
+    epoch_guard() : rec_(&epoch_domain::global().local()) { epoch_domain::global().pin(*rec_); }
+
+    epoch_guard(std::nullptr_t) noexcept {}
+
+    epoch_guard(const epoch_guard& other) {
+        if (other.rec_) {
+            rec_ = &epoch_domain::global().local();
+            epoch_domain::global().pin(*rec_);
+        }
+    }
+
+    epoch_guard(epoch_guard&& other) noexcept : rec_(std::exchange(other.rec_, nullptr)) {}
+
+    epoch_guard& operator=(epoch_guard other) noexcept {
+        std::swap(rec_, other.rec_);
+        return *this;
+    }
+
+    ~epoch_guard() { reset(); }
+
+    void reset() noexcept {
+        if (rec_) {
+            epoch_domain::global().unpin(*std::exchange(rec_, nullptr));
+        }
+    }
+
+    explicit operator bool() const noexcept { return rec_ != nullptr; }
+
+private:
+    epoch_domain::record* rec_ = nullptr;
+};
+
+#endif // EPOCH_RECLAMATION_H
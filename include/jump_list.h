@@ -4,11 +4,3522 @@
 #ifndef JUMP_LIST_H
 #define JUMP_LIST_H
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <compare>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <ostream>
+#include <random>
+#include <ranges>
+#include <ratio>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Building with JUMP_LIST_STATS=1 (the CMake option of the same name) turns
+// on jump_list_traits::collect_stats, so every plain-layout list counts its
+// operations; see jump_list::stats().
+#ifndef JUMP_LIST_STATS
+#define JUMP_LIST_STATS 0
+#endif
+
+namespace jl_detail {
+
+// Upper bound on tower height. With p = 1/2 the top level saturates only
+// after about 2^32 elements.
+inline constexpr int max_level = 32;
+
+// Hints that the cache line at p will be read soon. A no-op where the
+// compiler has no prefetch builtin.
+inline void prefetch(const void* p) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p);
+#else
+    (void)p;
+#endif
+}
+
+// Raw storage granule of the node pool. Every block handed out by the pool
+// is a whole number of units, so all blocks share the unit's alignment.
+template<std::size_t Align>
+struct alignas(Align) storage_unit {
+    unsigned char bytes[Align];
+};
+
+// Stands in for the prev pointer of nodes without backward links. It takes
+// no space under [[no_unique_address]], and assigning to it does nothing, so
+// the code that maintains prev pointers needs no branches.
+struct no_backward_link {
+    no_backward_link& operator=(const void*) noexcept { return *this; }
+};
+
+// Stands in for the slot of a free block in a pool that does not lend its
+// blocks out. Like no_backward_link it takes no space, and it reads as 0.
+struct no_slot {
+    no_slot& operator=(std::uint16_t) noexcept { return *this; }
+    operator std::uint16_t() const noexcept { return 0; }
+};
+
+// Fixed-size block allocator. Blocks are carved out of slabs obtained from
+// the container's allocator; freed blocks go on an intrusive free list and
+// are reused before a new slab is requested. The pool does not own the
+// allocator, it is passed in by the owning node_pool.
+//
+// A Lending pool can also lend a block in use out of the pool, for a node
+// handle or another container to keep. Every block has a slot, its index
+// in its slab, which the caller keeps with the block and which leads back
+// to the slab header. The block returns with reclaim() if its slab's pool
+// takes it back in, and with give_back() from anywhere else. A slab with
+// blocks on loan outlives release(): the last block given back frees it.
+template<typename UnitAllocator, bool Lending = false>
+class slab_pool {
+    using traits = std::allocator_traits<UnitAllocator>;
+    using unit = typename traits::value_type;
+
+    struct free_block {
+        free_block* next;
+        [[no_unique_address]] std::conditional_t<Lending, std::uint16_t, no_slot> slot;
+    };
+
+    struct slab_header {
+        slab_header* next;
+        std::size_t units;
+        // Null once the pool has released the slab.
+        slab_pool* owner;
+        std::size_t lent;
+    };
+
+    static constexpr std::size_t header_units = (sizeof(slab_header) + sizeof(unit) - 1) / sizeof(unit);
+    static constexpr std::size_t first_slab_blocks = 8;
+    static constexpr std::size_t max_slab_bytes = std::size_t{64} << 10;
+    // Slots are 16 bits wide. Slabs grown by doubling stop far below this.
+    static constexpr std::size_t max_slab_blocks = std::size_t{1} << 16;
+
+public:
+    slab_pool() noexcept = default;
+
+    slab_pool(const slab_pool&) = delete;
+    slab_pool& operator=(const slab_pool&) = delete;
+
+    slab_pool(slab_pool&& other) noexcept { take(other); }
+
+    slab_pool& operator=(slab_pool&& other) noexcept {
+        // The owner must have released this pool beforehand.
+        take(other);
+        return *this;
+    }
+
+    void set_block_size(std::size_t bytes) noexcept { block_units_ = units_for(bytes); }
+
+    std::size_t block_size() const noexcept { return block_units_ * sizeof(unit); }
+
+    void* allocate(UnitAllocator& alloc) {
+        std::uint16_t slot;
+        return allocate(alloc, slot);
+    }
+
+    // Also reports the slot of the block.
+    void* allocate(UnitAllocator& alloc, std::uint16_t& slot) {
+        if (free_) {
+            free_block* block = free_;
+            free_ = block->next;
+            --free_count_;
+            slot = block->slot;
+            return block;
+        }
+        if (cursor_ == end_) {
+            grow(alloc);
+        }
+        unit* block = cursor_;
+        cursor_ += block_units_;
+        slot = static_cast<std::uint16_t>(carved_++);
+        return block;
+    }
+
+    void deallocate(void* p, std::uint16_t slot = 0) noexcept {
+        free_block* block = ::new (p) free_block;
+        block->next = free_;
+        block->slot = slot;
+        free_ = block;
+        ++free_count_;
+    }
+
+    // Lends out a block of this pool that is in use.
+    void lend(void* p, std::uint16_t slot) noexcept
+        requires Lending
+    {
+        ++slab_of(p, slot, block_units_)->lent;
+    }
+
+    // Whether a block on loan comes from one of this pool's slabs.
+    bool owns(void* p, std::uint16_t slot) const noexcept
+        requires Lending
+    {
+        return slab_of(p, slot, block_units_)->owner == this;
+    }
+
+    // Takes back a block of this pool's slabs, which is in use again.
+    void reclaim(void* p, std::uint16_t slot) noexcept
+        requires Lending
+    {
+        --slab_of(p, slot, block_units_)->lent;
+    }
+
+    // Returns a block on loan that is no longer in use to the free list of
+    // the pool its slab belongs to, or, if that pool has released the slab,
+    // frees the slab once none of its blocks is on loan. block_bytes is
+    // the block size the block was allocated with.
+    static void give_back(UnitAllocator& alloc, void* p, std::uint16_t slot, std::size_t block_bytes) noexcept
+        requires Lending
+    {
+        slab_header* slab = slab_of(p, slot, units_for(block_bytes));
+        --slab->lent;
+        if (slab->owner) {
+            slab->owner->deallocate(p, slot);
+        } else if (slab->lent == 0) {
+            free_slab(alloc, slab);
+        }
+    }
+
+    // Makes sure the next blocks allocations are served without asking the
+    // allocator: whatever the free list and the current slab cannot cover
+    // comes from one slab of exactly the missing size, or from several if
+    // there are more blocks than slots.
+    void reserve(UnitAllocator& alloc, std::size_t blocks) {
+        std::size_t available = free_count_ + static_cast<std::size_t>(end_ - cursor_) / block_units_;
+        while (available < blocks) {
+            std::size_t missing = std::min(blocks - available, max_slab_blocks);
+            start_slab(alloc, missing);
+            available += missing;
+        }
+    }
+
+    // Returns every slab to the allocator at once, regardless of how many
+    // blocks are still handed out. Slabs with blocks on loan are only
+    // dropped from the pool, and wait for those blocks to be given back.
+    void release(UnitAllocator& alloc) noexcept {
+        while (slabs_) {
+            slab_header* slab = std::exchange(slabs_, slabs_->next);
+            if (slab->lent == 0) {
+                free_slab(alloc, slab);
+            } else {
+                slab->owner = nullptr;
+            }
+        }
+        free_ = nullptr;
+        free_count_ = 0;
+        cursor_ = end_ = nullptr;
+        carved_ = 0;
+        next_blocks_ = first_slab_blocks;
+    }
+
+    // Takes over the slabs of other, whose allocator must compare equal.
+    // Blocks other handed out stay valid and now belong to this pool; its
+    // free blocks and unused slab space join this pool's free list.
+    void splice(slab_pool& other) noexcept {
+        if (!other.slabs_) {
+            return;
+        }
+        other.free_rest();
+        if (other.free_) {
+            free_block* last = other.free_;
+            while (last->next) {
+                last = last->next;
+            }
+            last->next = free_;
+            free_ = other.free_;
+            free_count_ += other.free_count_;
+        }
+        slab_header* last = other.slabs_;
+        for (;; last = last->next) {
+            last->owner = this;
+            if (!last->next) {
+                break;
+            }
+        }
+        last->next = slabs_;
+        slabs_ = other.slabs_;
+        next_blocks_ = std::max(next_blocks_, other.next_blocks_);
+        other.free_ = nullptr;
+        other.free_count_ = 0;
+        other.cursor_ = other.end_ = nullptr;
+        other.carved_ = 0;
+        other.slabs_ = nullptr;
+        other.next_blocks_ = first_slab_blocks;
+    }
+
+private:
+    static std::size_t units_for(std::size_t bytes) noexcept {
+        return (std::max(bytes, sizeof(free_block)) + sizeof(unit) - 1) / sizeof(unit);
+    }
+
+    static slab_header* slab_of(void* p, std::uint16_t slot, std::size_t block_units) noexcept {
+        unit* first = static_cast<unit*>(p) - std::size_t{slot} * block_units;
+        return std::launder(reinterpret_cast<slab_header*>(first - header_units));
+    }
+
+    static void free_slab(UnitAllocator& alloc, slab_header* slab) noexcept {
+        std::size_t units = slab->units;
+        slab->~slab_header();
+        traits::deallocate(alloc, reinterpret_cast<unit*>(slab), units);
+    }
+
+    // Moves the blocks left in the current slab to the free list.
+    void free_rest() noexcept {
+        for (; cursor_ != end_; cursor_ += block_units_) {
+            deallocate(cursor_, static_cast<std::uint16_t>(carved_++));
+        }
+    }
+
+    // The slabs' owner pointers follow them, which for a lending pool
+    // takes a walk over the slabs.
+    void take(slab_pool& other) noexcept {
+        block_units_ = other.block_units_;
+        free_ = std::exchange(other.free_, nullptr);
+        free_count_ = std::exchange(other.free_count_, 0);
+        cursor_ = std::exchange(other.cursor_, nullptr);
+        end_ = std::exchange(other.end_, nullptr);
+        carved_ = std::exchange(other.carved_, 0);
+        slabs_ = std::exchange(other.slabs_, nullptr);
+        next_blocks_ = std::exchange(other.next_blocks_, first_slab_blocks);
+        if constexpr (Lending) {
+            for (slab_header* slab = slabs_; slab; slab = slab->next) {
+                slab->owner = this;
+            }
+        }
+    }
+
+    void start_slab(UnitAllocator& alloc, std::size_t blocks) {
+        std::size_t units = header_units + blocks * block_units_;
+        unit* raw = traits::allocate(alloc, units);
+        free_rest();
+        slabs_ = ::new (static_cast<void*>(raw)) slab_header{slabs_, units, this, 0};
+        cursor_ = raw + header_units;
+        end_ = raw + units;
+        carved_ = 0;
+    }
+
+    void grow(UnitAllocator& alloc) {
+        start_slab(alloc, next_blocks_);
+        if (next_blocks_ * 2 * block_size() <= max_slab_bytes) {
+            next_blocks_ *= 2;
+        }
+    }
+
+    std::size_t block_units_ = 1;
+    free_block* free_ = nullptr;
+    std::size_t free_count_ = 0;
+    unit* cursor_ = nullptr;
+    unit* end_ = nullptr;
+    // Blocks carved from the current slab so far, the slot of the next.
+    std::size_t carved_ = 0;
+    slab_header* slabs_ = nullptr;
+    std::size_t next_blocks_ = first_slab_blocks;
+};
+
+// Set of slab pools, one bucket per size class, sharing one allocator.
+// jump_list keeps nodes of height h in bucket h - 1, so every allocation
+// and free is a free-list push or pop. A Lending set also counts the
+// blocks its container borrowed from other pools, which the container
+// returns with return_borrowed() before the set is released.
+template<typename UnitAllocator, std::size_t Buckets = max_level, bool Lending = false>
+class node_pool {
+    using traits = std::allocator_traits<UnitAllocator>;
+    using pool = slab_pool<UnitAllocator, Lending>;
+
+public:
+    static constexpr std::size_t buckets = Buckets;
+
+    template<typename SizeOf>
+    node_pool(const UnitAllocator& alloc, SizeOf size_of) noexcept : alloc_(alloc) {
+        for (std::size_t b = 0; b < buckets; ++b) {
+            pools_[b].set_block_size(size_of(b));
+        }
+    }
+
+    node_pool(const node_pool&) = delete;
+    node_pool& operator=(const node_pool&) = delete;
+
+    node_pool(node_pool&& other) noexcept
+        : alloc_(other.alloc_), pools_(std::move(other.pools_)), borrowed_(std::exchange(other.borrowed_, 0)) {}
+
+    ~node_pool() { release(); }
+
+    void* allocate(std::size_t bucket) { return pools_[bucket].allocate(alloc_); }
+
+    void* allocate(std::size_t bucket, std::uint16_t& slot) { return pools_[bucket].allocate(alloc_, slot); }
+
+    void deallocate(std::size_t bucket, void* p, std::uint16_t slot = 0) noexcept {
+        pools_[bucket].deallocate(p, slot);
+    }
+
+    void reserve(std::size_t bucket, std::size_t blocks) { pools_[bucket].reserve(alloc_, blocks); }
+
+    // Lends out a block in use, which is either one of this set's own or
+    // one it borrowed; the latter simply stays on loan.
+    void lend(std::size_t bucket, void* p, std::uint16_t slot, bool borrowed) noexcept {
+        if (borrowed) {
+            --borrowed_;
+        } else {
+            pools_[bucket].lend(p, slot);
+        }
+    }
+
+    // Takes in a block on loan that is in use again, reclaiming it if it
+    // comes from this set's slabs and borrowing it otherwise. Returns
+    // whether it was borrowed.
+    bool take_in(std::size_t bucket, void* p, std::uint16_t slot) noexcept {
+        if (pools_[bucket].owns(p, slot)) {
+            pools_[bucket].reclaim(p, slot);
+            return false;
+        }
+        ++borrowed_;
+        return true;
+    }
+
+    // Gives a borrowed block that is no longer in use back to its slab.
+    void return_borrowed(std::size_t bucket, void* p, std::uint16_t slot) noexcept {
+        --borrowed_;
+        pool::give_back(alloc_, p, slot, pools_[bucket].block_size());
+    }
+
+    static void give_back(UnitAllocator& alloc, void* p, std::uint16_t slot, std::size_t block_bytes) noexcept {
+        pool::give_back(alloc, p, slot, block_bytes);
+    }
+
+    std::size_t borrowed() const noexcept { return borrowed_; }
+
+    void release() noexcept {
+        for (auto& pool : pools_) {
+            pool.release(alloc_);
+        }
+        borrowed_ = 0;
+    }
+
+    // Takes over the slabs of other. If PropagateAlloc is false the caller
+    // guarantees both allocators compare equal.
+    template<bool PropagateAlloc>
+    void take(node_pool& other) noexcept {
+        release();
+        if constexpr (PropagateAlloc) {
+            alloc_ = other.alloc_;
+        }
+        for (std::size_t b = 0; b < buckets; ++b) {
+            pools_[b] = std::move(other.pools_[b]);
+        }
+        borrowed_ = std::exchange(other.borrowed_, 0);
+    }
+
+    // Adds the slabs of other, which must use an equal allocator, to this
+    // pool, so nodes allocated from other can be freed through this one.
+    void splice(node_pool& other) noexcept {
+        for (std::size_t b = 0; b < buckets; ++b) {
+            pools_[b].splice(other.pools_[b]);
+        }
+        borrowed_ += std::exchange(other.borrowed_, 0);
+    }
+
+    const UnitAllocator& allocator() const noexcept { return alloc_; }
+
+private:
+    [[no_unique_address]] UnitAllocator alloc_;
+    std::array<pool, buckets> pools_;
+    std::size_t borrowed_ = 0;
+};
+
+// wyrand: one 64x64->128 multiply per draw, passes BigCrush. Falls back to
+// splitmix64 where there is no 128-bit integer type.
+class wyrand {
+public:
+    explicit wyrand(std::uint64_t seed) noexcept : state_(seed) {}
+
+    std::uint64_t operator()() noexcept {
+        state_ += 0xa0761d6478bd642full;
+#if defined(__SIZEOF_INT128__)
+        __uint128_t t = static_cast<__uint128_t>(state_) * (state_ ^ 0xe7037ed1a0b428dbull);
+        return static_cast<std::uint64_t>(t >> 64) ^ static_cast<std::uint64_t>(t);
+#else
+        std::uint64_t z = state_;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+#endif
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+// Distinct seed for every new generator. Only the first call touches
+// std::random_device.
+inline std::uint64_t fresh_seed() noexcept {
+    static std::atomic<std::uint64_t> next{(std::uint64_t{std::random_device{}()} << 32) ^ std::random_device{}()};
+    return next.fetch_add(0x9e3779b97f4a7c15ull, std::memory_order_relaxed);
+}
+
+// Three-way comparison that falls back to operator< for types without <=>.
+struct synth_three_way {
+    template<typename T>
+    constexpr auto operator()(const T& a, const T& b) const {
+        if constexpr (std::three_way_comparable<T>) {
+            return a <=> b;
+        } else {
+            if (a < b) return std::weak_ordering::less;
+            if (b < a) return std::weak_ordering::greater;
+            return std::weak_ordering::equivalent;
+        }
+    }
+};
+
+// Snapshot stream format written by jump_list::save. A header (magic,
+// version, encoding, element size, element count) is followed by chunks,
+// each a varint element count, a varint byte length and that many bytes of
+// payload, and a chunk of zero elements ends the stream. Integral keys are
+// stored as zigzag varint deltas from the previous key, anything else as raw
+// bytes. Chunks are framed so a reader never consumes past the snapshot,
+// and neither side holds more than one chunk in memory.
+inline constexpr char snapshot_magic[6] = {'J', 'L', 'S', 'N', 'A', 'P'};
+inline constexpr unsigned char snapshot_version = 1;
+inline constexpr std::size_t snapshot_chunk_bytes = std::size_t{64} << 10;
+inline constexpr std::size_t max_varint_bytes = 10;
+
+enum class snapshot_encoding : unsigned char { raw_little = 0, raw_big = 1, varint_delta = 2 };
+
+template<typename T>
+inline constexpr snapshot_encoding snapshot_encoding_for =
+    std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= sizeof(std::uint64_t)
+        ? snapshot_encoding::varint_delta
+        : (std::endian::native == std::endian::big ? snapshot_encoding::raw_big : snapshot_encoding::raw_little);
+
+template<typename T>
+inline constexpr std::size_t snapshot_element_bytes =
+    snapshot_encoding_for<T> == snapshot_encoding::varint_delta ? max_varint_bytes : sizeof(T);
+
+[[noreturn]] inline void snapshot_error(const char* what) {
+    throw std::runtime_error(std::string("jump_list snapshot: ") + what);
+}
+
+inline char* put_varint(char* p, std::uint64_t v) noexcept {
+    while (v >= 0x80) {
+        *p++ = static_cast<char>(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = static_cast<char>(v);
+    return p;
+}
+
+inline std::uint64_t get_varint(const char*& p, const char* end) {
+    std::uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == end) {
+            snapshot_error("truncated chunk");
+        }
+        auto byte = static_cast<unsigned char>(*p++);
+        v |= std::uint64_t{byte & 0x7fu} << shift;
+        if (byte < 0x80) {
+            return v;
+        }
+    }
+    snapshot_error("malformed varint");
+}
+
+inline std::uint64_t read_varint(std::istream& is) {
+    char buf[max_varint_bytes];
+    std::size_t n = 0;
+    do {
+        if (n == max_varint_bytes || !is.get(buf[n])) {
+            snapshot_error(n == max_varint_bytes ? "malformed varint" : "truncated stream");
+        }
+    } while (static_cast<unsigned char>(buf[n++]) >= 0x80);
+    const char* p = buf;
+    return get_varint(p, buf + n);
+}
+
 template<typename T>
+class snapshot_writer {
+    static constexpr snapshot_encoding encoding = snapshot_encoding_for<T>;
+    static constexpr std::size_t capacity = snapshot_chunk_bytes + snapshot_element_bytes<T>;
+
+public:
+    snapshot_writer(std::ostream& os, std::uint64_t count) : os_(os), buffer_(new char[capacity]) {
+        char* p = buffer_.get();
+        p = std::copy(std::begin(snapshot_magic), std::end(snapshot_magic), p);
+        *p++ = static_cast<char>(snapshot_version);
+        *p++ = static_cast<char>(encoding);
+        p = put_varint(p, sizeof(T));
+        p = put_varint(p, count);
+        write(buffer_.get(), static_cast<std::size_t>(p - buffer_.get()));
+    }
+
+    void put(const T& v) {
+        if (used_ >= snapshot_chunk_bytes) {
+            flush();
+        }
+        if constexpr (encoding == snapshot_encoding::varint_delta) {
+            using U = std::make_unsigned_t<T>;
+            using S = std::make_signed_t<U>;
+            auto d = static_cast<S>(static_cast<U>(static_cast<U>(v) - static_cast<U>(prev_)));
+            auto zigzag = (static_cast<std::uint64_t>(static_cast<std::int64_t>(d)) << 1) ^
+                          static_cast<std::uint64_t>(static_cast<std::int64_t>(d) >> 63);
+            used_ = static_cast<std::size_t>(put_varint(buffer_.get() + used_, zigzag) - buffer_.get());
+            prev_ = static_cast<U>(v);
+        } else {
+            std::memcpy(buffer_.get() + used_, std::addressof(v), sizeof(T));
+            used_ += sizeof(T);
+        }
+        ++count_;
+    }
+
+    // Writes the last chunk and the end marker.
+    void finish() {
+        flush();
+        char end = 0;
+        write(&end, 1);
+        os_.flush();
+        if (!os_) {
+            snapshot_error("write failed");
+        }
+    }
+
+private:
+    void flush() {
+        if (count_ == 0) {
+            return;
+        }
+        char frame[2 * max_varint_bytes];
+        char* p = put_varint(put_varint(frame, count_), used_);
+        write(frame, static_cast<std::size_t>(p - frame));
+        write(buffer_.get(), used_);
+        count_ = 0;
+        used_ = 0;
+    }
+
+    void write(const char* p, std::size_t n) {
+        if (!os_.write(p, static_cast<std::streamsize>(n))) {
+            snapshot_error("write failed");
+        }
+    }
+
+    std::ostream& os_;
+    std::unique_ptr<char[]> buffer_;
+    std::size_t used_ = 0;
+    std::uint64_t count_ = 0;
+    std::uint64_t prev_ = 0;
+};
+
+template<typename T>
+class snapshot_reader {
+    static constexpr snapshot_encoding encoding = snapshot_encoding_for<T>;
+    static constexpr std::size_t capacity = snapshot_chunk_bytes + snapshot_element_bytes<T>;
+
+public:
+    // Reads and checks the header.
+    explicit snapshot_reader(std::istream& is) : is_(is), buffer_(new char[capacity]) {
+        char head[sizeof(snapshot_magic) + 2];
+        if (!is_.read(head, sizeof(head))) {
+            snapshot_error("truncated stream");
+        }
+        if (!std::equal(std::begin(snapshot_magic), std::end(snapshot_magic), head)) {
+            snapshot_error("bad magic");
+        }
+        if (static_cast<unsigned char>(head[6]) != snapshot_version) {
+            snapshot_error("unsupported version");
+        }
+        if (static_cast<snapshot_encoding>(head[7]) != encoding || read_varint(is_) != sizeof(T)) {
+            snapshot_error("element type mismatch");
+        }
+        remaining_ = read_varint(is_);
+    }
+
+    // Decodes the next chunk into out. Returns false at the end marker, by
+    // which point exactly the announced number of elements has been read.
+    bool next(std::vector<T>& out) {
+        out.clear();
+        std::uint64_t count = read_varint(is_);
+        if (count == 0) {
+            if (remaining_ != 0) {
+                snapshot_error("element count mismatch");
+            }
+            return false;
+        }
+        std::uint64_t bytes = read_varint(is_);
+        if (count > remaining_ || bytes > capacity) {
+            snapshot_error("corrupt chunk header");
+        }
+        remaining_ -= count;
+        if (!is_.read(buffer_.get(), static_cast<std::streamsize>(bytes))) {
+            snapshot_error("truncated stream");
+        }
+        const char* p = buffer_.get();
+        const char* end = p + bytes;
+        out.reserve(static_cast<std::size_t>(count));
+        for (std::uint64_t i = 0; i < count; ++i) {
+            if constexpr (encoding == snapshot_encoding::varint_delta) {
+                using U = std::make_unsigned_t<T>;
+                std::uint64_t zigzag = get_varint(p, end);
+                auto d = static_cast<U>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+                auto v = static_cast<U>(static_cast<U>(prev_) + d);
+                prev_ = v;
+                out.push_back(static_cast<T>(v));
+            } else {
+                if (static_cast<std::size_t>(end - p) < sizeof(T)) {
+                    snapshot_error("truncated chunk");
+                }
+                std::array<unsigned char, sizeof(T)> raw;
+                std::memcpy(raw.data(), p, sizeof(T));
+                p += sizeof(T);
+                out.push_back(std::bit_cast<T>(raw));
+            }
+        }
+        if (p != end) {
+            snapshot_error("trailing bytes in chunk");
+        }
+        return true;
+    }
+
+private:
+    std::istream& is_;
+    std::unique_ptr<char[]> buffer_;
+    std::uint64_t remaining_ = 0;
+    std::uint64_t prev_ = 0;
+};
+
+// save() of every layout: the elements of list in order.
+template<typename List>
+void save_snapshot(std::ostream& os, const List& list) {
+    snapshot_writer<typename List::value_type> out(os, list.size());
+    for (const auto& v : list) {
+        out.put(v);
+    }
+    out.finish();
+}
+
+// load() of every layout. The layout supplies append(first, last), its
+// linear bulk build for sorted input past the current last element, and
+// last(), that element. Each chunk must continue key_comp() order; on any
+// error the list is left empty.
+template<typename List, typename Append, typename Last>
+void load_snapshot(std::istream& is, List& list, Append append, Last last) {
+    using T = typename List::value_type;
+    auto comp = list.key_comp();
+    list.clear();
+    try {
+        snapshot_reader<T> in(is);
+        std::vector<T> chunk;
+        while (in.next(chunk)) {
+            if ((!list.empty() && comp(chunk.front(), last())) || !std::is_sorted(chunk.begin(), chunk.end(), comp)) {
+                snapshot_error("keys out of order");
+            }
+            append(chunk.begin(), chunk.end());
+        }
+    } catch (...) {
+        list.clear();
+        throw;
+    }
+}
+
+} // namespace jl_detail
+
+// Snapshot of the counters kept by a list whose traits set collect_stats.
+// Searches are the descents behind lookups, inserts and erasures; batch
+// lookups and bulk builds are not counted.
+struct jump_list_stats {
+    static constexpr std::size_t latency_buckets = 40;
+
+    // Sampled durations of one kind of operation: buckets[b] counts the
+    // samples that took [2^(b-1), 2^b) nanoseconds, the last bucket
+    // everything longer.
+    struct latency_histogram {
+        std::uint64_t samples = 0;
+        std::array<std::uint64_t, latency_buckets> buckets{};
+    };
+
+    std::uint64_t searches = 0;
+    // Comparator calls made by the searches.
+    std::uint64_t comparisons = 0;
+    // Forward steps the searches took on each level.
+    std::array<std::uint64_t, jl_detail::max_level> hops{};
+    // Live towers of each height, heights[h - 1] for height h.
+    std::array<std::uint64_t, jl_detail::max_level> heights{};
+    std::uint64_t node_allocations = 0;
+    std::uint64_t node_frees = 0;
+    latency_histogram insert;
+    latency_histogram find;
+    latency_histogram erase;
+
+    double comparisons_per_search() const noexcept {
+        return searches == 0 ? 0.0 : static_cast<double>(comparisons) / static_cast<double>(searches);
+    }
+};
+
+// Shape of a list as reported by jump_list::height_profile(). Search cost
+// counts the links a search follows plus one step down per level; the
+// expected value is Pugh's bound L(n) / p + 1 / (1 - p), L(n) = log_1/p(n),
+// for the level probability p of the list's level policy.
+struct jump_list_profile {
+    // nodes[i] is the number of nodes on level i, that is, taller than i.
+    std::array<std::size_t, jl_detail::max_level> nodes{};
+    int levels = 0;
+    double expected_cost = 0;
+    // Mean over all elements of the cost of a search from the head.
+    double actual_cost = 0;
+};
+
+namespace jl_detail {
+
+// Recycles coroutine frames per thread, so that lookups started by the
+// million do not each go to operator new. Frames are kept by size, a few
+// sizes and a bounded number of each; a frame may be freed on another
+// thread than the one that allocated it.
+class frame_cache {
+public:
+    static void* allocate(std::size_t n) {
+        if (gone_) {
+            return ::operator new(n);
+        }
+        auto& bins = local().bins_;
+        for (auto& b : bins) {
+            if (b.size == n && !b.free.empty()) {
+                void* p = b.free.back();
+                b.free.pop_back();
+                return p;
+            }
+        }
+        return ::operator new(n);
+    }
+
+    static void deallocate(void* p, std::size_t n) noexcept {
+        if (gone_) {
+            ::operator delete(p, n);
+            return;
+        }
+        auto& bins = local().bins_;
+        for (auto& b : bins) {
+            if (b.size == n || b.size == 0) {
+                if (b.free.size() < max_frames) {
+                    try {
+                        b.free.push_back(p);
+                        b.size = n;
+                        return;
+                    } catch (...) {
+                    }
+                }
+                break;
+            }
+        }
+        ::operator delete(p, n);
+    }
+
+    frame_cache(const frame_cache&) = delete;
+    frame_cache& operator=(const frame_cache&) = delete;
+
+    ~frame_cache() {
+        gone_ = true;
+        for (auto& b : bins_) {
+            for (void* p : b.free) {
+                ::operator delete(p, b.size);
+            }
+        }
+    }
+
+private:
+    static constexpr std::size_t max_frames = 256;
+
+    struct bin {
+        std::size_t size = 0;
+        std::vector<void*> free;
+    };
+
+    frame_cache() = default;
+
+    static frame_cache& local() {
+        thread_local frame_cache cache;
+        return cache;
+    }
+
+    std::array<bin, 4> bins_;
+    // Set once this thread's cache is destroyed, for frames freed by later
+    // thread_local or static destructors.
+    static inline thread_local bool gone_ = false;
+};
+
+} // namespace jl_detail
+
+// One lookup started by jump_list::find_async(), run a hop at a time. It
+// starts suspended; every resume() advances its descent to the next node
+// it has to read, prefetches that node and suspends again, so a caller that
+// resumes many lookups in turn (see lookup_scheduler in jump_list_async.h)
+// overlaps their cache misses. Move-only; the list must outlive it and must
+// not be modified while it runs.
+template<typename Result>
+class jump_list_lookup {
+public:
+    struct promise_type {
+        Result value{};
+        std::exception_ptr error;
+
+        jump_list_lookup get_return_object() noexcept {
+            return jump_list_lookup(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value(Result v) noexcept { value = v; }
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+
+        static void* operator new(std::size_t n) { return jl_detail::frame_cache::allocate(n); }
+        static void operator delete(void* p, std::size_t n) noexcept { jl_detail::frame_cache::deallocate(p, n); }
+    };
+
+    jump_list_lookup(jump_list_lookup&& other) noexcept : h_(std::exchange(other.h_, nullptr)) {}
+
+    jump_list_lookup& operator=(jump_list_lookup other) noexcept {
+        std::swap(h_, other.h_);
+        return *this;
+    }
+
+    ~jump_list_lookup() {
+        if (h_) {
+            h_.destroy();
+        }
+    }
+
+    bool done() const noexcept { return h_.done(); }
+
+    // Advances the lookup by one hop. Must not be called once done().
+    void resume() const { h_.resume(); }
+
+    // Runs the lookup to completion and returns its result, rethrowing
+    // whatever the comparator threw.
+    Result get() const {
+        while (!h_.done()) {
+            h_.resume();
+        }
+        if (h_.promise().error) {
+            std::rethrow_exception(h_.promise().error);
+        }
+        return h_.promise().value;
+    }
+
+private:
+    explicit jump_list_lookup(std::coroutine_handle<promise_type> h) noexcept : h_(h) {}
+
+    std::coroutine_handle<promise_type> h_;
+};
+
+namespace jl_detail {
+
+// Counters behind jump_list::stats(). Every member is a relaxed atomic, so
+// concurrent const lookups stay safe; a search accumulates its counts in a
+// local probe and publishes them once. One operation in 64 of each kind is
+// timed. The recorder belongs to one list object and is never copied.
+template<bool Enabled>
+class stats_recorder {
+    using counter = std::atomic<std::uint64_t>;
+    using clock = std::chrono::steady_clock;
+
+    static constexpr std::uint64_t sample_mask = 63;
+
+    struct latency {
+        counter ops{0};
+        counter samples{0};
+        std::array<counter, jump_list_stats::latency_buckets> buckets{};
+    };
+
+public:
+    enum operation { insert_op, find_op, erase_op };
+
+    // Counts of one search.
+    struct probe {
+        void compared() noexcept { ++comparisons; }
+        void hopped(int level) noexcept { ++hops[level]; }
+
+        std::uint64_t comparisons = 0;
+        std::array<std::uint32_t, max_level> hops{};
+    };
+
+    // Records the time until its destruction, if the operation was sampled.
+    class timer {
+    public:
+        explicit timer(latency* target) noexcept : target_(target) {
+            if (target_) {
+                start_ = clock::now();
+            }
+        }
+
+        timer(const timer&) = delete;
+        timer& operator=(const timer&) = delete;
+
+        ~timer() {
+            if (target_) {
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_).count();
+                std::size_t b = std::min<std::size_t>(std::bit_width(static_cast<std::uint64_t>(ns)),
+                                                      jump_list_stats::latency_buckets - 1);
+                target_->buckets[b].fetch_add(1, std::memory_order_relaxed);
+                target_->samples.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        latency* target_;
+        clock::time_point start_;
+    };
+
+    stats_recorder() noexcept = default;
+    stats_recorder(const stats_recorder&) = delete;
+    stats_recorder& operator=(const stats_recorder&) = delete;
+
+    void searched(const probe& p) noexcept {
+        searches_.fetch_add(1, std::memory_order_relaxed);
+        comparisons_.fetch_add(p.comparisons, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < p.hops.size(); ++i) {
+            if (p.hops[i] != 0) {
+                hops_[i].fetch_add(p.hops[i], std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void allocated() noexcept { allocations_.fetch_add(1, std::memory_order_relaxed); }
+    void freed(std::uint64_t n = 1) noexcept { frees_.fetch_add(n, std::memory_order_relaxed); }
+
+    [[nodiscard]] timer time(operation op) noexcept {
+        latency& l = latencies_[op];
+        return timer((l.ops.fetch_add(1, std::memory_order_relaxed) & sample_mask) == 0 ? &l : nullptr);
+    }
+
+    void fill(jump_list_stats& s) const noexcept {
+        auto load = [](const counter& c) { return c.load(std::memory_order_relaxed); };
+        s.searches = load(searches_);
+        s.comparisons = load(comparisons_);
+        for (std::size_t i = 0; i < hops_.size(); ++i) {
+            s.hops[i] = load(hops_[i]);
+        }
+        s.node_allocations = load(allocations_);
+        s.node_frees = load(frees_);
+        jump_list_stats::latency_histogram* out[] = {&s.insert, &s.find, &s.erase};
+        for (std::size_t op = 0; op < latencies_.size(); ++op) {
+            out[op]->samples = load(latencies_[op].samples);
+            for (std::size_t b = 0; b < latencies_[op].buckets.size(); ++b) {
+                out[op]->buckets[b] = load(latencies_[op].buckets[b]);
+            }
+        }
+    }
+
+    void reset() noexcept {
+        auto zero = [](counter& c) { c.store(0, std::memory_order_relaxed); };
+        zero(searches_);
+        zero(comparisons_);
+        std::for_each(hops_.begin(), hops_.end(), zero);
+        zero(allocations_);
+        zero(frees_);
+        for (auto& l : latencies_) {
+            zero(l.ops);
+            zero(l.samples);
+            std::for_each(l.buckets.begin(), l.buckets.end(), zero);
+        }
+    }
+
+private:
+    counter searches_{0};
+    counter comparisons_{0};
+    std::array<counter, max_level> hops_{};
+    counter allocations_{0};
+    counter frees_{0};
+    std::array<latency, 3> latencies_{};
+};
+
+// Default build: every hook is an empty inline function and the recorder
+// takes no space in the list.
+template<>
+class stats_recorder<false> {
+public:
+    enum operation { insert_op, find_op, erase_op };
+
+    struct probe {
+        void compared() noexcept {}
+        void hopped(int) noexcept {}
+    };
+
+    struct timer {};
+
+    void searched(const probe&) noexcept {}
+    void allocated() noexcept {}
+    void freed(std::uint64_t = 1) noexcept {}
+    timer time(operation) noexcept { return {}; }
+};
+
+} // namespace jl_detail
+
+// Tag selecting the constructors that take input already sorted by the
+// container's comparator. Same type as the C++23 flat_multiset tag where the
+// library provides it.
+#if defined(__cpp_lib_flat_map)
+using std::sorted_equivalent_t;
+using std::sorted_equivalent;
+#else
+struct sorted_equivalent_t {
+    explicit sorted_equivalent_t() = default;
+};
+inline constexpr sorted_equivalent_t sorted_equivalent{};
+#endif
+
+template<typename Compare, typename T>
+concept jump_list_comparator = std::strict_weak_order<const Compare&, const T&, const T&>;
+
+// Probe types for heterogeneous lookup: Compare declares is_transparent and
+// orders K against T either way round.
+template<typename K, typename Compare, typename T>
+concept jump_list_lookup_key = requires { typename Compare::is_transparent; } &&
+                               std::predicate<const Compare&, const K&, const T&> &&
+                               std::predicate<const Compare&, const T&, const K&>;
+
+// Level policies draw tower heights. A policy is default constructible and
+// its call operator returns a height in [1, limit], where limit is what the
+// list currently allows given its size.
+
+// Geometric heights with P(height > h) = p^h for p = P::num / P::den. When
+// p is 1/2^k the height is read off as countr_zero of one wyrand draw,
+// without branches; other ratios (such as 1/e) compare the draw against a
+// precomputed table, about 1 / (1 - p) steps on average.
+template<typename P = std::ratio<1, 2>>
+class geometric_levels {
+    static_assert(P::num > 0 && P::num < P::den, "the level probability must lie in (0, 1)");
+
+    static constexpr bool power_of_two = P::num == 1 && std::has_single_bit(static_cast<std::uint64_t>(P::den));
+
+    static constexpr std::array<std::uint64_t, jl_detail::max_level> make_thresholds() {
+        std::array<std::uint64_t, jl_detail::max_level> t{};
+        long double q = 1;
+        for (auto& x : t) {
+            x = q >= 1 ? ~std::uint64_t{0} : static_cast<std::uint64_t>(q * 18446744073709551616.0L);
+            q = q * P::num / P::den;
+        }
+        return t;
+    }
+
+    // thresholds[h] is p^h scaled to the range of a draw.
+    static constexpr auto thresholds = make_thresholds();
+
+public:
+    using probability = P;
+
+    geometric_levels() noexcept : geometric_levels(jl_detail::fresh_seed()) {}
+    explicit geometric_levels(std::uint64_t seed) noexcept : rng_(seed) {}
+
+    int operator()(int limit) noexcept {
+        std::uint64_t draw = rng_();
+        if constexpr (power_of_two) {
+            constexpr int shift = std::countr_zero(static_cast<std::uint64_t>(P::den));
+            return std::min(std::countr_zero(draw) / shift + 1, limit);
+        } else {
+            int h = 1;
+            while (h < limit && draw < thresholds[h]) {
+                ++h;
+            }
+            return h;
+        }
+    }
+
+private:
+    jl_detail::wyrand rng_;
+};
+
+// 1/e minimizes the expected number of comparisons per search.
+using inverse_e = std::ratio<367879441171442, 1000000000000000>;
+
+// Same distribution as geometric_levels but always seeded with Seed, so a
+// given sequence of operations builds the same towers on every run.
+template<typename P = std::ratio<1, 2>, std::uint64_t Seed = 0x853c49e6748fea9bull>
+class deterministic_levels : public geometric_levels<P> {
+public:
+    deterministic_levels() noexcept : geometric_levels<P>(Seed) {}
+};
+
+// Layout and tuning options of a jump_list, passed as its fourth template
+// argument. The defaults describe the classic skip list; derive from
+// jump_list_traits and redefine members to change them.
+struct jump_list_traits {
+    // Elements stored per bottom-level node. Values above 1 select the
+    // unrolled layout from jump_list_fat.h, which needs a trivially copyable
+    // element type.
+    static constexpr std::size_t keys_per_node = 1;
+
+    // Draws the height of each new tower.
+    using level_policy = geometric_levels<>;
+
+    // Stores on every forward link the number of elements it skips, which
+    // enables nth(), rank(), index_of() and O(log n) advance() and
+    // distance() at the cost of one size_t per link. Plain layout only.
+    static constexpr bool indexable = false;
+
+    // Tallest tower the list builds, at most jl_detail::max_level. The head
+    // and the pool keep one slot per level, so lists known to stay small
+    // can choose a lower cap; searches stay O(log n) up to about 2^max_level
+    // elements.
+    static constexpr int max_level = jl_detail::max_level;
+
+    // Counts searches, comparisons, hops per level, node allocations and
+    // frees, and samples operation latencies; read them with stats().
+    // Plain layout only. Off by default, or on for every list when built
+    // with JUMP_LIST_STATS=1.
+    static constexpr bool collect_stats = JUMP_LIST_STATS != 0;
+
+    // Links nodes by 32-bit offsets into one contiguous arena instead of by
+    // pointers, the layout from jump_list_compact.h: about half the per-node
+    // overhead, but elements move as the arena grows. Needs a trivially
+    // copyable element type and keys_per_node of 1.
+    static constexpr bool compact_links = false;
+
+    // Keeps a pointer to the previous element in every node, so --it is
+    // O(1). Without it each node is a pointer smaller and iterators are
+    // forward iterators; reverse_iterator then carries its own search path,
+    // which keeps reverse scans O(1) amortized per step. Plain layout only.
+    static constexpr bool backward_links = true;
+};
+
+template<std::size_t K>
+struct fat_node_traits : jump_list_traits {
+    static constexpr std::size_t keys_per_node = K;
+};
+
+struct indexable_traits : jump_list_traits {
+    static constexpr bool indexable = true;
+};
+
+template<int MaxLevel>
+struct capped_level_traits : jump_list_traits {
+    static constexpr int max_level = MaxLevel;
+};
+
+struct stats_traits : jump_list_traits {
+    static constexpr bool collect_stats = true;
+};
+
+struct compact_traits : jump_list_traits {
+    static constexpr bool compact_links = true;
+};
+
+struct forward_only_traits : jump_list_traits {
+    static constexpr bool backward_links = false;
+};
+
+// Ordered multiset built on a skip list. Elements are kept in ascending order
+// according to Compare; equivalent elements keep their insertion order.
+// Nodes and their towers of forward links come from a slab pool that draws
+// memory from Allocator in large chunks.
+template<typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>,
+         typename Traits = jump_list_traits>
+    requires jump_list_comparator<Compare, T>
 class jump_list {
+    static_assert(Traits::max_level >= 1 && Traits::max_level <= jl_detail::max_level,
+                  "max_level must lie in [1, jl_detail::max_level]");
+
+    static constexpr bool indexable = Traits::indexable;
+    static constexpr bool backward_links = Traits::backward_links;
+
+    struct node;
+
+    struct plain_link {
+        node* next;
+    };
+
+    // width is the number of level-0 steps the link covers.
+    struct counted_link {
+        node* next;
+        std::size_t width;
+    };
+
+    using link = std::conditional_t<indexable, counted_link, plain_link>;
+
+    // A node is one pool block: the value first, then the bookkeeping
+    // fields and a trailing array of `height` forward links, so a hop reads
+    // the key and the link to follow from the same cache line. The links
+    // start at sizeof(node), which the alignment keeps a multiple of theirs
+    // when prev takes no space. slot locates the block's slab for node
+    // handles; borrowed is set while the slab belongs to another list.
+    struct alignas(std::max(alignof(T), alignof(link))) node {
+        union {
+            T value;
+        };
+        std::int8_t height;
+        bool borrowed;
+        std::uint16_t slot;
+        [[no_unique_address]] std::conditional_t<backward_links, node*, jl_detail::no_backward_link> prev;
+
+        node() noexcept {}
+        ~node() {}
+
+        link* links() noexcept { return reinterpret_cast<link*>(this + 1); }
+        node*& next(int i) noexcept { return links()[i].next; }
+        std::size_t& width(int i) noexcept
+            requires indexable
+        {
+            return links()[i].width;
+        }
+    };
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using unit = jl_detail::storage_unit<std::max(alignof(node), alignof(void*))>;
+    using unit_allocator = typename alloc_traits::template rebind_alloc<unit>;
+    using level_policy = typename Traits::level_policy;
+
+    static constexpr int max_level = Traits::max_level;
+
+    using pool_type = jl_detail::node_pool<unit_allocator, max_level, true>;
+    using stats_type = jl_detail::stats_recorder<Traits::collect_stats>;
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = typename alloc_traits::pointer;
+    using const_pointer = typename alloc_traits::const_pointer;
+
+    // Elements are immutable in place, so iterator and const_iterator are the
+    // same type, as permitted for associative containers.
+    // Without backward links they are forward iterators.
+    class const_iterator {
+    public:
+        using iterator_category =
+            std::conditional_t<backward_links, std::bidirectional_iterator_tag, std::forward_iterator_tag>;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() noexcept = default;
+
+        reference operator*() const noexcept { return node_->value; }
+        pointer operator->() const noexcept { return std::addressof(node_->value); }
+
+        const_iterator& operator++() noexcept {
+            node_ = node_->next(0);
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        const_iterator& operator--() noexcept
+            requires backward_links
+        {
+            node_ = node_->prev;
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept
+            requires backward_links
+        {
+            const_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        friend bool operator==(const const_iterator&, const const_iterator&) = default;
+
+    private:
+        friend class jump_list;
+
+        explicit const_iterator(node* n) noexcept : node_(n) {}
+
+        node* node_ = nullptr;
+    };
+
+    using iterator = const_iterator;
+
+    // Reverse iterator of lists without backward links. It carries the
+    // search path to its element: the last node before it on every level,
+    // the element itself on level 0. Stepping back only rebuilds the path on
+    // the levels the element occupies, each by a short walk from the path
+    // one level up, so a reverse scan costs O(1) amortized per step rather
+    // than a search per step. Any insertion or erasure invalidates it.
+    class reverse_path_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        reverse_path_iterator() noexcept = default;
+
+        reference operator*() const noexcept { return path_[0]->value; }
+        pointer operator->() const noexcept { return std::addressof(path_[0]->value); }
+
+        reverse_path_iterator& operator++() noexcept {
+            node* n = path_[0];
+            node* x = path_[n->height];
+            for (int i = n->height - 1; i >= 0; --i) {
+                while (x->next(i) != n) {
+                    x = x->next(i);
+                }
+                path_[i] = x;
+            }
+            return *this;
+        }
+
+        reverse_path_iterator operator++(int) noexcept {
+            reverse_path_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        reverse_path_iterator& operator--() noexcept {
+            node* n = path_[0]->next(0);
+            std::fill(path_.begin(), path_.begin() + n->height, n);
+            return *this;
+        }
+
+        reverse_path_iterator operator--(int) noexcept {
+            reverse_path_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        // The forward iterator one past the element, as for
+        // std::reverse_iterator.
+        const_iterator base() const noexcept { return const_iterator(path_[0]->next(0)); }
+
+        friend bool operator==(const reverse_path_iterator& a, const reverse_path_iterator& b) noexcept {
+            return a.path_[0] == b.path_[0];
+        }
+
+    private:
+        friend class jump_list;
+
+        // The head stands in on every level above the tallest tower, and in
+        // the extra slot past max_level that ++ reads for the tallest ones.
+        std::array<node*, max_level + 1> path_{};
+    };
+
+    using reverse_iterator =
+        std::conditional_t<backward_links, std::reverse_iterator<iterator>, reverse_path_iterator>;
+    using const_reverse_iterator = reverse_iterator;
+
+    // Owns an element taken out by extract() together with its node and
+    // tower, which stay where they are in the slab of the list they came
+    // from. The slab counts the node as on loan, so like a std::multiset
+    // handle this one outlives that list being cleared or destroyed: a
+    // released slab waits for its nodes on loan. Dropping the handle gives
+    // the block back to the free list of the list that owns the slab, or
+    // frees a released slab through the handle's copy of the allocator, so
+    // it counts as a change to that list.
+    class node_type {
+    public:
+        using value_type = T;
+        using allocator_type = Allocator;
+
+        constexpr node_type() noexcept = default;
+
+        node_type(node_type&& other) noexcept
+            : node_(std::exchange(other.node_, nullptr)), alloc_(std::move(other.alloc_)) {
+            other.alloc_.reset();
+        }
+
+        node_type& operator=(node_type&& other) noexcept {
+            if (this != &other) {
+                reset();
+                node_ = std::exchange(other.node_, nullptr);
+                alloc_ = std::move(other.alloc_);
+                other.alloc_.reset();
+            }
+            return *this;
+        }
+
+        ~node_type() { reset(); }
+
+        [[nodiscard]] bool empty() const noexcept { return node_ == nullptr; }
+        explicit operator bool() const noexcept { return node_ != nullptr; }
+
+        value_type& value() const noexcept { return node_->value; }
+        allocator_type get_allocator() const { return *alloc_; }
+
+        void swap(node_type& other) noexcept {
+            std::swap(node_, other.node_);
+            alloc_.swap(other.alloc_);
+        }
+
+        friend void swap(node_type& a, node_type& b) noexcept { a.swap(b); }
+
+    private:
+        friend class jump_list;
+
+        node_type(node* n, const allocator_type& alloc) noexcept : node_(n), alloc_(alloc) {}
+
+        // Gives up the node, which a list has just linked in.
+        node* release() noexcept {
+            alloc_.reset();
+            return std::exchange(node_, nullptr);
+        }
+
+        void reset() noexcept {
+            if (node_) {
+                Allocator alloc(*alloc_);
+                alloc_traits::destroy(alloc, std::addressof(node_->value));
+                std::size_t bytes = node_size(node_->height);
+                std::uint16_t slot = node_->slot;
+                node_->~node();
+                unit_allocator units(alloc);
+                pool_type::give_back(units, release(), slot, bytes);
+            }
+        }
+
+        node* node_ = nullptr;
+        std::optional<allocator_type> alloc_;
+    };
+
+private:
+    // Levels that keep a lookout ahead of a scan_iterator, and how many
+    // towers of its level each lookout runs ahead.
+    static constexpr int scan_levels = std::min(2, max_level - 1);
+    static constexpr int scan_lead = 4;
+
+public:
+    // Forward iterator for long scans. Stepping a plain iterator waits for
+    // each next(0) load in turn; this one also keeps a lookout scan_lead
+    // towers ahead on levels 1 and 2. Whenever the scan steps off a tower
+    // of such a level, that level's lookout takes one more hop, prefetching
+    // the node it lands on and the level-0 successor of the node it left,
+    // so most nodes are already in cache when the scan reaches them. The
+    // lookouts only read the list; they never pass end().
+    class scan_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        scan_iterator() noexcept = default;
+
+        reference operator*() const noexcept { return node_->value; }
+        pointer operator->() const noexcept { return std::addressof(node_->value); }
+
+        scan_iterator& operator++() noexcept {
+            int h = node_->height;
+            node_ = node_->next(0);
+            for (int l = 1; l < h && l <= scan_levels; ++l) {
+                look_ahead(l);
+            }
+            return *this;
+        }
+
+        scan_iterator operator++(int) noexcept {
+            scan_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        // The plain iterator at the same position.
+        const_iterator base() const noexcept { return const_iterator(node_); }
+
+        friend bool operator==(const scan_iterator& a, const scan_iterator& b) noexcept {
+            return a.node_ == b.node_;
+        }
+
+        friend bool operator==(const scan_iterator& a, const const_iterator& b) noexcept {
+            return a.node_ == b.node_;
+        }
+
+    private:
+        friend class jump_list;
+
+        // first[l - 1] is the first node at or after x on level l.
+        scan_iterator(node* x, const std::array<node*, scan_levels>& first, node* end) noexcept
+            : node_(x), end_(end), lookout_(first) {
+            for (int l = 1; l <= scan_levels; ++l) {
+                for (int k = 0; k < scan_lead; ++k) {
+                    look_ahead(l);
+                }
+            }
+        }
+
+        void look_ahead(int l) noexcept {
+            node*& a = lookout_[l - 1];
+            if (a != end_) {
+                jl_detail::prefetch(a->next(0));
+                a = a->next(l);
+                jl_detail::prefetch(a);
+            }
+        }
+
+        node* node_ = nullptr;
+        node* end_ = nullptr;
+        std::array<node*, scan_levels> lookout_{};
+    };
+
+    // Construction and destruction
+
+    jump_list() : jump_list(Compare()) {}
+
+    explicit jump_list(const Compare& comp, const Allocator& alloc = Allocator())
+        : comp_(comp), pool_(unit_allocator(alloc), &bucket_size) {
+        reset_head();
+    }
+
+    explicit jump_list(const Allocator& alloc) : jump_list(Compare(), alloc) {}
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    jump_list(It first, It last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : jump_list(comp, alloc) {
+        insert(first, last);
+    }
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    jump_list(It first, It last, const Allocator& alloc) : jump_list(first, last, Compare(), alloc) {}
+
+    // Builds the list from [first, last), which must be sorted by comp, in one
+    // linear pass without any searching or random level draws.
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    jump_list(sorted_equivalent_t, It first, It last, const Compare& comp = Compare(),
+              const Allocator& alloc = Allocator())
+        : jump_list(comp, alloc) {
+        append_sorted(first, last);
+    }
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    jump_list(sorted_equivalent_t, It first, It last, const Allocator& alloc)
+        : jump_list(sorted_equivalent, first, last, Compare(), alloc) {}
+
+    jump_list(std::initializer_list<T> init, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : jump_list(comp, alloc) {
+        insert(init);
+    }
+
+    jump_list(std::initializer_list<T> init, const Allocator& alloc) : jump_list(init, Compare(), alloc) {}
+
+    jump_list(const jump_list& other)
+        : jump_list(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+    jump_list(const jump_list& other, const Allocator& alloc) : jump_list(other.comp_, alloc) {
+        clone_from(other);
+        finger_enabled_ = other.finger_enabled_;
+    }
+
+    jump_list(jump_list&& other) noexcept
+        : comp_(other.comp_), pool_(std::move(other.pool_)), finger_enabled_(other.finger_enabled_),
+          levels_(other.levels_) {
+        reset_head();
+        adopt_links(other);
+    }
+
+    jump_list(jump_list&& other, const Allocator& alloc) : jump_list(other.comp_, alloc) {
+        if (get_allocator() == other.get_allocator()) {
+            pool_.template take<false>(other.pool_);
+            adopt_links(other);
+        } else {
+            move_elements_from(other);
+        }
+    }
+
+    ~jump_list() { destroy_values(); }
+
+    // When copying an element cannot throw (and the allocator stays), the
+    // nodes already here are recycled through the pool's free lists, so a
+    // destination at least as large as other with similar towers needs no
+    // new memory. Otherwise the copy is built aside and swapped in, which
+    // leaves this list untouched if an element copy throws.
+    jump_list& operator=(const jump_list& other) {
+        if (this == &other) {
+            return *this;
+        }
+        constexpr bool propagate = alloc_traits::propagate_on_container_copy_assignment::value;
+        if (std::is_nothrow_copy_constructible_v<T> && (!propagate || get_allocator() == other.get_allocator())) {
+            recycle_nodes();
+            comp_ = other.comp_;
+            finger_enabled_ = false;
+            clone_from(other);
+            finger_enabled_ = other.finger_enabled_;
+        } else {
+            jump_list tmp(other, propagate ? other.get_allocator() : get_allocator());
+            swap_storage<true>(tmp);
+        }
+        return *this;
+    }
+
+    jump_list& operator=(jump_list&& other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+        constexpr bool propagate = alloc_traits::propagate_on_container_move_assignment::value;
+        clear();
+        comp_ = other.comp_;
+        if (propagate || get_allocator() == other.get_allocator()) {
+            pool_.template take<propagate>(other.pool_);
+            adopt_links(other);
+        } else {
+            move_elements_from(other);
+        }
+        return *this;
+    }
+
+    jump_list& operator=(std::initializer_list<T> init) {
+        jump_list tmp(init, comp_, get_allocator());
+        swap_storage<true>(tmp);
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return allocator_type(pool_.allocator()); }
+
+    // Iterators
+
+    iterator begin() const noexcept { return iterator(head()->next(0)); }
+    iterator end() const noexcept { return iterator(head()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    // O(log n) without backward links, which have to find the last element.
+    reverse_iterator rbegin() const noexcept {
+        if constexpr (backward_links) {
+            return reverse_iterator(end());
+        } else {
+            reverse_path_iterator it;
+            rank_array rank;
+            last_nodes(it.path_.data(), rank.data());
+            it.path_[max_level] = head();
+            return it;
+        }
+    }
+
+    reverse_iterator rend() const noexcept {
+        if constexpr (backward_links) {
+            return reverse_iterator(begin());
+        } else {
+            reverse_path_iterator it;
+            it.path_.fill(head());
+            return it;
+        }
+    }
+
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    size_type size() const noexcept { return size_; }
+    size_type max_size() const noexcept {
+        return static_cast<size_type>(std::numeric_limits<difference_type>::max()) / sizeof(node);
+    }
+
+    // Modifiers
+
+    // Destroys all elements and hands every slab back to the allocator.
+    // Trivially destructible elements are not visited at all, unless some
+    // nodes were borrowed through node handles from another list.
+    void clear() noexcept {
+        stats_.freed(size_);
+        destroy_values();
+        pool_.release();
+        reset_head();
+    }
+
+    iterator insert(const T& value) { return emplace_node(value); }
+    iterator insert(T&& value) { return emplace_node(std::move(value)); }
+
+    // Inserts value as close as possible before hint. When the hint is a
+    // valid position no key comparisons are made beyond validating it: the
+    // predecessors are collected by stepping back from hint, expected
+    // O(log n) steps, or, with finger_search() enabled, taken from the
+    // finger if it was left right in front of hint. Each insert leaves it
+    // there, so a run of inserts at one hint, such as appending with
+    // hint == end(), costs O(1) each after the first.
+    iterator insert(const_iterator hint, const T& value) { return emplace_hint_node(hint.node_, value); }
+    iterator insert(const_iterator hint, T&& value) { return emplace_hint_node(hint.node_, std::move(value)); }
+
+    // Construct the element in its node from args; placement as in insert.
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    iterator emplace(Args&&... args) {
+        return emplace_node(std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    iterator emplace_hint(const_iterator hint, Args&&... args) {
+        return emplace_hint_node(hint.node_, std::forward<Args>(args)...);
+    }
+
+    // Unlinks the element at pos and hands it over with its node, so it can
+    // be modified (even re-keyed) and inserted into this list or another
+    // one without a copy or a new allocation.
+    node_type extract(const_iterator pos) noexcept {
+        node* n = pos.node_;
+        unlink(n);
+        pool_.lend(static_cast<std::size_t>(n->height) - 1, n, n->slot, n->borrowed);
+        stats_.freed();
+        return node_type(n, get_allocator());
+    }
+
+    // Extracts the first element equivalent to key, if any.
+    node_type extract(const T& key) {
+        node* n = find_node(key);
+        return n == head() ? node_type() : extract(iterator(n));
+    }
+
+    // Inserts the element owned by nh, which is left empty, and returns its
+    // position, or end() if nh was empty. If the handle's allocator equals
+    // this list's, whichever list it came from, its node and tower are
+    // linked in as they are; otherwise the element is moved into a node of
+    // this list's own.
+    iterator insert(node_type&& nh) {
+        if (nh.empty()) {
+            return end();
+        }
+        if (!can_adopt(nh)) {
+            iterator it = emplace_node(std::move(nh.value()));
+            nh.reset();
+            return it;
+        }
+        iterator it = link_node(nh.node_);
+        take_in(nh.release());
+        return it;
+    }
+
+    iterator insert(const_iterator hint, node_type&& nh) {
+        if (nh.empty()) {
+            return end();
+        }
+        if (!can_adopt(nh)) {
+            iterator it = emplace_hint_node(hint.node_, std::move(nh.value()));
+            nh.reset();
+            return it;
+        }
+        iterator it = link_hinted(nh.node_, hint.node_);
+        take_in(nh.release());
+        return it;
+    }
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    void insert(It first, It last) {
+        if constexpr (std::forward_iterator<It> && std::same_as<std::iter_value_t<It>, T>) {
+            if (std::is_sorted(first, last, comp_)) {
+                insert_sorted(std::ranges::subrange(first, last));
+                return;
+            }
+        }
+        for (; first != last; ++first) {
+            emplace_node(*first);
+        }
+    }
+
+    void insert(std::initializer_list<T> init) { insert(init.begin(), init.end()); }
+
+    // Inserts a range sorted by key_comp(). Appending past the current last
+    // element builds the new towers left to right in O(m); otherwise the
+    // range is merged in with one walk along level 0, unless the range is so
+    // short that m searches, each resuming from the previous insertion
+    // point, are cheaper than that walk.
+    // If an element constructor throws, the elements inserted before it stay.
+    template<std::ranges::input_range R>
+        requires std::constructible_from<T, std::ranges::range_reference_t<R>>
+    void insert_sorted(R&& range) {
+        auto first = std::ranges::begin(range);
+        auto last = std::ranges::end(range);
+        if (first == last) {
+            return;
+        }
+        if (size_ == 0) {
+            append_sorted(std::move(first), std::move(last));
+            return;
+        }
+        if constexpr (std::ranges::forward_range<R>) {
+            if constexpr (std::same_as<std::ranges::range_value_t<R>, T>) {
+                if (!comp_(*first, last_node()->value)) {
+                    append_sorted(std::move(first), std::move(last));
+                    return;
+                }
+            }
+            auto m = static_cast<size_type>(std::ranges::distance(first, last));
+            if (m * static_cast<size_type>(std::bit_width(size_)) < size_) {
+                link_sorted(std::move(first), std::move(last));
+                return;
+            }
+        }
+        merge_sorted(std::move(first), std::move(last));
+    }
+
+    iterator erase(const_iterator pos) {
+        [[maybe_unused]] auto timer = stats_.time(stats_type::erase_op);
+        node* n = pos.node_;
+        node* next = n->next(0);
+        unlink(n);
+        destroy_node(n);
+        return iterator(next);
+    }
+
+    // Unlinks the whole run with one predecessor search and returns its
+    // nodes to the pool in the same pass: O(log n + k) for k erased
+    // elements.
+    iterator erase(const_iterator first, const_iterator last) {
+        [[maybe_unused]] auto timer = stats_.time(stats_type::erase_op);
+        node* from = first.node_;
+        node* to = last.node_;
+        if (from == to) {
+            return iterator(to);
+        }
+        if (from == head()->next(0) && to == head()) {
+            clear();
+            return end();
+        }
+        node* update[max_level];
+        rank_array rank;
+        path_to(from, update, rank.data());
+        [[maybe_unused]] size_type from_rank = 0;
+        if constexpr (indexable) {
+            from_rank = rank[0] + 1;
+        }
+        // One walk over the run frees it and records, for every level it
+        // reaches, the node after it (and that node's old position).
+        node* after[max_level];
+        [[maybe_unused]] rank_array after_rank;
+        int height = 0;
+        size_type k = 0;
+        while (from != to) {
+            node* n = std::exchange(from, from->next(0));
+            for (int i = 0; i < n->height; ++i) {
+                after[i] = n->next(i);
+                if constexpr (indexable) {
+                    after_rank[i] = from_rank + k + n->width(i);
+                }
+            }
+            height = std::max<int>(height, n->height);
+            ++k;
+            destroy_node(n);
+        }
+        for (int i = 0; i < height; ++i) {
+            if constexpr (indexable) {
+                update[i]->width(i) = after_rank[i] - k - rank[i];
+            }
+            update[i]->next(i) = after[i];
+        }
+        if constexpr (indexable) {
+            for (int i = height; i < level; ++i) {
+                update[i]->width(i) -= k;
+            }
+        }
+        to->prev = update[0];
+        while (level > 1 && head()->next(level - 1) == head()) {
+            --level;
+        }
+        size_ -= k;
+        reset_finger();
+        return iterator(to);
+    }
+
+    size_type erase(const T& key) {
+        auto [first, last] = equal_range(key);
+        size_type old_size = size_;
+        erase(first, last);
+        return old_size - size_;
+    }
+
+    // Detaches the elements not less than key into a new list. Only the
+    // shorter side is moved to fresh nodes, so this costs O(log n) plus the
+    // smaller of the two parts. Basic exception guarantee.
+    jump_list split(const T& key) {
+        node* cut = lower_bound_node(key);
+        // Step towards both ends at once to find the shorter side.
+        node* front = head()->next(0);
+        node* back = cut;
+        while (front != cut && back != head()) {
+            front = front->next(0);
+            back = back->next(0);
+        }
+        jump_list tail(comp_, get_allocator());
+        if (back == head()) {
+            transfer_run(tail, cut, head());
+            erase(iterator(cut), end());
+            return tail;
+        }
+        tail.pool_.template take<false>(pool_);
+        tail.adopt_links(*this);
+        try {
+            tail.transfer_run(*this, tail.head()->next(0), cut);
+        } catch (...) {
+            clear();
+            pool_.template take<false>(tail.pool_);
+            adopt_links(tail);
+            throw;
+        }
+        tail.erase(tail.begin(), iterator(cut));
+        return tail;
+    }
+
+    // Moves every element of other into this list, after the equivalent
+    // elements already here. With equal allocators the nodes are relinked
+    // rather than copied: the slabs of other join this list's pool, a run
+    // that lies entirely after (or before) this list is spliced on with
+    // O(log n) link updates, and interleaved elements are linked one by one
+    // by a search that resumes from the previous insertion point. If a
+    // comparison throws there, the elements of other not yet merged are
+    // destroyed.
+    void merge(jump_list& other) {
+        if (&other == this || other.size_ == 0) {
+            return;
+        }
+        if (!(get_allocator() == other.get_allocator())) {
+            move_elements_from(other);
+            return;
+        }
+        pool_.splice(other.pool_);
+        if (size_ == 0) {
+            adopt_links(other);
+        } else if (!comp_(other.head()->next(0)->value, last_node()->value)) {
+            append_links(other);
+        } else if (comp_(other.last_node()->value, head()->next(0)->value)) {
+            prepend_links(other);
+        } else {
+            relink_from(other);
+        }
+    }
+
+    void merge(jump_list&& other) { merge(other); }
+
+    void swap(jump_list& other) noexcept(std::is_nothrow_swappable_v<Compare>) {
+        swap_storage<alloc_traits::propagate_on_container_swap::value>(other);
+    }
+
+    friend void swap(jump_list& a, jump_list& b) noexcept(noexcept(a.swap(b))) { a.swap(b); }
+
+    // Lookup
+
+    size_type count(const T& key) const {
+        auto [first, last] = equal_range(key);
+        return static_cast<size_type>(std::distance(first, last));
+    }
+
+    iterator find(const T& key) const { return iterator(find_node(key)); }
+
+    bool contains(const T& key) const { return find(key) != end(); }
+
+    iterator lower_bound(const T& key) const { return iterator(lower_bound_node(key)); }
+    iterator upper_bound(const T& key) const { return iterator(upper_bound_node(key)); }
+
+    std::pair<iterator, iterator> equal_range(const T& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // Heterogeneous lookup for transparent comparators: the probe is
+    // compared with the elements as is, so a list of std::string ordered by
+    // std::less<> is searched with a std::string_view or a const char*
+    // without building a std::string.
+
+    template<jump_list_lookup_key<Compare, T> K>
+    size_type count(const K& key) const {
+        auto [first, last] = equal_range(key);
+        return static_cast<size_type>(std::distance(first, last));
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator find(const K& key) const {
+        return iterator(find_node(key));
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    bool contains(const K& key) const {
+        return find(key) != end();
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator lower_bound(const K& key) const {
+        return iterator(lower_bound_node(key));
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator upper_bound(const K& key) const {
+        return iterator(upper_bound_node(key));
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    std::pair<iterator, iterator> equal_range(const K& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // Batched lookup: out[i] receives find(keys[i]); out must be at least as
+    // long as keys. The probes are taken in sorted order and split into
+    // contiguous runs, one per lane. The lanes' descents advance one hop at a
+    // time in turn, each prefetching the node it compares next, so the cache
+    // misses of different lanes overlap instead of stalling one after
+    // another. Within a run each descent starts from the predecessors left
+    // by the previous probe, like a finger search. The finger is not used.
+    void find_batch(std::span<const T> keys, std::span<iterator> out) const {
+        lower_bound_batch(keys, [&](size_type i, node* n) {
+            out[i] = iterator(n != head() && !comp_(keys[i], n->value) ? n : head());
+        });
+    }
+
+    void contains_batch(std::span<const T> keys, std::span<bool> out) const {
+        lower_bound_batch(keys, [&](size_type i, node* n) { out[i] = n != head() && !comp_(keys[i], n->value); });
+    }
+
+    // find(key) as a coroutine for interleaving with other lookups whose
+    // keys arrive one by one: each resume() takes one hop and suspends
+    // after prefetching the next node to compare, unless that node was
+    // already compared one level up. The key is copied into the frame.
+    // Plain layout; the finger is not used.
+    jump_list_lookup<iterator> find_async(T key) const { return find_coroutine(std::move(key)); }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    jump_list_lookup<iterator> find_async(K key) const {
+        return find_coroutine(std::move(key));
+    }
+
+    // Positional access, for indexable lists only. Each call is one
+    // O(log n) descent that sums the spans of the links it follows;
+    // index_of() and the functions built on it also walk the equivalent
+    // elements before the one asked about.
+
+    // The element at index i, or end() if i >= size().
+    iterator nth(size_type i) const noexcept
+        requires indexable
+    {
+        if (i >= size_) {
+            return end();
+        }
+        node* x = head();
+        size_type pos = 0;
+        for (int l = level - 1; l >= 0 && pos <= i; --l) {
+            while (pos + x->width(l) <= i + 1) {
+                pos += x->width(l);
+                x = x->next(l);
+            }
+        }
+        return iterator(x);
+    }
+
+    // Number of elements less than key, i.e. the index of lower_bound(key).
+    size_type rank(const T& key) const
+        requires indexable
+    {
+        node* update[max_level];
+        rank_array rank;
+        descend([&](node* x) { return comp_(x->value, key); }, update, rank.data());
+        return rank[0];
+    }
+
+    size_type index_of(const_iterator pos) const noexcept
+        requires indexable
+    {
+        return pos.node_ == head() ? size_ : node_rank(pos.node_) - 1;
+    }
+
+    iterator advance(const_iterator pos, difference_type k) const noexcept
+        requires indexable
+    {
+        return nth(static_cast<size_type>(static_cast<difference_type>(index_of(pos)) + k));
+    }
+
+    difference_type distance(const_iterator first, const_iterator last) const noexcept
+        requires indexable
+    {
+        return static_cast<difference_type>(index_of(last)) - static_cast<difference_type>(index_of(first));
+    }
+
+    // Range scans
+
+    // The whole list, or [lower_bound(lo), lower_bound(hi)), as a range of
+    // scan_iterators.
+    std::ranges::subrange<scan_iterator> scan() const noexcept {
+        std::array<node*, scan_levels> first;
+        for (int l = 1; l <= scan_levels; ++l) {
+            first[l - 1] = head()->next(l);
+        }
+        return {scan_iterator(head()->next(0), first, head()), scan_end(head())};
+    }
+
+    std::ranges::subrange<scan_iterator> scan(const T& lo, const T& hi) const {
+        return {scan_at(lo), scan_end(lower_bound_node(hi))};
+    }
+
+    // Calls f on every element in [lo, hi), in order, through a
+    // scan_iterator. Each element is compared with hi instead of searching
+    // for the end of the range first.
+    template<typename F>
+        requires std::invocable<F&, const T&>
+    void for_each_range(const T& lo, const T& hi, F f) const {
+        scan_each(lo, hi, f);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    std::ranges::subrange<scan_iterator> scan(const K& lo, const K& hi) const {
+        return {scan_at(lo), scan_end(lower_bound_node(hi))};
+    }
+
+    template<jump_list_lookup_key<Compare, T> K, typename F>
+        requires std::invocable<F&, const T&>
+    void for_each_range(const K& lo, const K& hi, F f) const {
+        scan_each(lo, hi, f);
+    }
+
+    // Parallel iteration
+
+    // Cuts the list into at most n non-empty, contiguous subranges of
+    // roughly equal length, in order, for separate threads to work on. The
+    // cuts are spread evenly over the nodes of the highest level that has
+    // at least n log2(size) of them, so no level-0 walk is needed and each
+    // part spans about log2(size) of that level's random gaps, which keeps
+    // the parts within a small factor of each other: O(n log size).
+    // Indexable lists cut at exact positions instead.
+    std::vector<std::ranges::subrange<const_iterator>> partition(size_type n) const {
+        std::vector<std::ranges::subrange<const_iterator>> parts;
+        n = std::min(n, size_);
+        if (n == 0) {
+            return parts;
+        }
+        std::vector<node*> cuts;
+        if constexpr (indexable) {
+            for (size_type j = 1; j < n; ++j) {
+                cuts.push_back(nth(size_ * j / n).node_);
+            }
+        } else {
+            std::vector<node*> row;
+            auto wanted = n * static_cast<size_type>(std::bit_width(size_));
+            for (int i = level - 1; i >= 0 && row.size() < wanted; --i) {
+                row.clear();
+                for (node* x = head()->next(i); x != head(); x = x->next(i)) {
+                    row.push_back(x);
+                }
+            }
+            // Index 0 is skipped, as the first part starts at begin().
+            for (size_type j = 1; j < n; ++j) {
+                cuts.push_back(row[row.size() * j / n]);
+            }
+        }
+        cuts.push_back(head());
+        node* from = head()->next(0);
+        for (node* to : cuts) {
+            parts.emplace_back(iterator(from), iterator(to));
+            from = to;
+        }
+        return parts;
+    }
+
+    // Finger search. When enabled, the list caches the per-level
+    // predecessors of its last search, insertion or erasure, and the next
+    // lookup or insert starts from there. A key d positions away is reached
+    // in O(log d) instead of O(log n), which suits mostly increasing keys.
+    // Lookups then update the cache, so concurrent const calls on one list
+    // are no longer safe while it is enabled.
+
+    void finger_search(bool enabled) noexcept {
+        finger_enabled_ = enabled;
+        reset_finger();
+    }
+
+    bool finger_search() const noexcept { return finger_enabled_; }
+
+    // Statistics
+
+    // Counters since construction or the last reset_stats(), for traits
+    // with collect_stats; a copied or moved-to list starts from zero. The
+    // height histogram is read off the list, which takes O(n).
+    jump_list_stats stats() const
+        requires Traits::collect_stats
+    {
+        jump_list_stats s;
+        stats_.fill(s);
+        for (node* n = head()->next(0); n != head(); n = n->next(0)) {
+            ++s.heights[n->height - 1];
+        }
+        return s;
+    }
+
+    void reset_stats() noexcept
+        requires Traits::collect_stats
+    {
+        stats_.reset();
+    }
+
+    // Structure health
+
+    // Node counts per level and the expected and actual search cost, in one
+    // O(n) walk along level 0.
+    jump_list_profile height_profile() const {
+        jump_list_profile profile;
+        profile.levels = level;
+        // run[i]: nodes passed on level i since the last node reaching
+        // level i + 1, which are exactly the hops a search makes there.
+        std::array<size_type, max_level> run{};
+        size_type hops = 0;
+        double total = 0;
+        for (node* n = head()->next(0); n != head(); n = n->next(0)) {
+            total += static_cast<double>(hops);
+            for (int i = 0; i < n->height; ++i) {
+                ++profile.nodes[i];
+            }
+            for (int i = 0; i + 1 < n->height; ++i) {
+                hops -= run[i];
+                run[i] = 0;
+            }
+            ++run[n->height - 1];
+            ++hops;
+        }
+        if (size_ != 0) {
+            double p = level_probability();
+            double n = static_cast<double>(size_);
+            profile.expected_cost = std::log(n) / std::log(1 / p) / p + 1 / (1 - p);
+            profile.actual_cost = total / n + level;
+        }
+        return profile;
+    }
+
+    // Re-levels up to budget towers, resuming where the previous call
+    // stopped and wrapping around at the end, so repeated calls from an
+    // idle hook sweep the whole list in O(budget + log n) steps each. Towers
+    // are reshaped towards a deterministic skip list: between two nodes
+    // that reach level i + 1 there are 1 to ceil(1/p) + 1 nodes of height
+    // i + 1, with heights kept wherever they already fit. A tower that does
+    // not fit is rebuilt in a new node, which invalidates iterators to its
+    // element; on an exception the list stays valid and the next call
+    // retries that element. Returns the number of towers rebuilt.
+    size_type rebalance(size_type budget) {
+        if (size_ == 0 || budget == 0) {
+            return 0;
+        }
+        node* n = rebalance_cursor_ ? rebalance_cursor_ : head()->next(0);
+        node* update[max_level];
+        rank_array rank{};
+        std::fill(std::begin(update), std::end(update), head());
+        path_to(n, update, rank.data());
+        // gap[i]: nodes on level i since the last one reaching level i + 1,
+        // the head reaching every level.
+        std::array<size_type, max_level> gap{};
+        for (int i = 0; i < level; ++i) {
+            for (node* x = i + 1 < level ? update[i + 1] : head(); x != update[i]; x = x->next(i)) {
+                ++gap[i];
+            }
+        }
+        size_type rebuilt = 0;
+        try {
+            for (; budget > 0 && n != head(); --budget) {
+                node* next = n->next(0);
+                int height = 1;
+                while (height < max_level && gap[height - 1] != 0 &&
+                       (gap[height - 1] >= max_gap || n->height > height)) {
+                    ++height;
+                }
+                if (height != n->height) {
+                    node* m = create_node(height, std::move_if_noexcept(n->value));
+                    replace_node(n, m, update, rank.data());
+                    destroy_node(n);
+                    ++rebuilt;
+                } else {
+                    [[maybe_unused]] size_type r = 0;
+                    if constexpr (indexable) {
+                        r = rank[0] + 1;
+                    }
+                    for (int i = 0; i < height; ++i) {
+                        update[i] = n;
+                        if constexpr (indexable) {
+                            rank[i] = r;
+                        }
+                    }
+                }
+                std::fill(gap.begin(), gap.begin() + height - 1, 0);
+                ++gap[height - 1];
+                n = next;
+            }
+        } catch (...) {
+            rebalance_cursor_ = n;
+            reset_finger();
+            throw;
+        }
+        rebalance_cursor_ = n == head() ? nullptr : n;
+        reset_finger();
+        return rebuilt;
+    }
+
+    // Serialization
+
+    // Writes the elements in order as a snapshot of keys only, no towers:
+    // zigzag varint deltas for integral keys, raw bytes otherwise, streamed
+    // in chunks of about 64 KiB. Throws std::runtime_error if the stream
+    // fails.
+    void save(std::ostream& os) const
+        requires std::is_trivially_copyable_v<T>
+    {
+        jl_detail::save_snapshot(os, *this);
+    }
+
+    // Replaces the contents with a snapshot written by save(), one chunk at
+    // a time through the linear sorted bulk build. Throws std::runtime_error
+    // on a malformed stream, a different element type or keys out of
+    // key_comp() order, and leaves the list empty in that case.
+    void load(std::istream& is)
+        requires std::is_trivially_copyable_v<T>
+    {
+        jl_detail::load_snapshot(
+            is, *this, [this](auto first, auto last) { append_sorted(first, last); },
+            [this]() -> const T& { return last_node()->value; });
+    }
+
+    // Observers
+
+    key_compare key_comp() const { return comp_; }
+    value_compare value_comp() const { return comp_; }
+
+    // Comparison
+
+    // Lists of different sizes are told apart without a walk.
+    friend bool operator==(const jump_list& a, const jump_list& b) {
+        return a.size_ == b.size_ && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    friend auto operator<=>(const jump_list& a, const jump_list& b) {
+        return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end(),
+                                                      jl_detail::synth_three_way{});
+    }
+
+    // Set operations
+
+    // Multiset union, intersection and difference with the semantics of
+    // std::set_union and friends: an element occurring m times in a and n
+    // times in b occurs max(m, n), min(m, n) or max(m - n, 0) times in the
+    // result, copies from a coming first. Both lists must be ordered by
+    // equivalent comparators; the result takes a's comparator and
+    // allocator. Instead of a merge that compares every element, each list
+    // skips a run of elements missing from the other with a finger search
+    // from where it stands, O(log d) for a run of length d, so comparisons
+    // total O(m log(n/m)) for lists of m <= n elements; copying the result
+    // is linear in its size.
+    friend jump_list set_union(const jump_list& a, const jump_list& b) {
+        return a.combine<true, true, true>(b);
+    }
+
+    friend jump_list set_intersection(const jump_list& a, const jump_list& b) {
+        return a.combine<false, true, false>(b);
+    }
+
+    friend jump_list set_difference(const jump_list& a, const jump_list& b) {
+        return a.combine<true, false, false>(b);
+    }
+
+private:
+    // Positions (1-based, the head is 0) of the nodes in an update array.
+    // Only indexable lists track them.
+    using rank_array = std::array<size_type, indexable ? max_level : 0>;
+
+    // p of the level policy, or 1/2 if it does not name one.
+    static constexpr double level_probability() noexcept {
+        if constexpr (requires { typename level_policy::probability; }) {
+            using p = typename level_policy::probability;
+            return static_cast<double>(p::num) / static_cast<double>(p::den);
+        } else {
+            return 0.5;
+        }
+    }
+
+    // Longest run rebalance() allows on a level between two nodes that
+    // reach the level above: ceil(1/p) + 1, which is 3 for p = 1/2.
+    static constexpr size_type max_gap = [] {
+        if constexpr (requires { typename level_policy::probability; }) {
+            using p = typename level_policy::probability;
+            return static_cast<size_type>((p::den + p::num - 1) / p::num) + 1;
+        } else {
+            return size_type{3};
+        }
+    }();
+
+    static std::size_t node_size(int height) noexcept { return sizeof(node) + height * sizeof(link); }
+
+    static std::size_t bucket_size(std::size_t bucket) noexcept { return node_size(static_cast<int>(bucket) + 1); }
+
+    node* head() const noexcept {
+        return std::launder(reinterpret_cast<node*>(const_cast<unsigned char*>(head_storage_)));
+    }
+
+    // Empty sentinel: every level of the head points back at the head, so
+    // the list is circular on all levels and end() is the head itself.
+    void reset_head() noexcept {
+        node* h = ::new (static_cast<void*>(head_storage_)) node;
+        h->height = max_level;
+        h->prev = h;
+        for (int i = 0; i < max_level; ++i) {
+            h->next(i) = h;
+            if constexpr (indexable) {
+                h->width(i) = 1;
+            }
+        }
+        level = 1;
+        size_ = 0;
+        rebalance_cursor_ = nullptr;
+        reset_finger();
+    }
+
+    void reset_finger() const noexcept {
+        std::fill(std::begin(finger_), std::end(finger_), head());
+        finger_rank_.fill(0);
+    }
+
+    // Towers never grow past about log2(size) + 1, so a short list does not
+    // start every search from a needlessly tall head.
+    int random_level() { return levels_(std::min(static_cast<int>(std::bit_width(size_)) + 1, max_level)); }
+
+    // Fills update[0, level) with the last node on each level that lies
+    // before the cut point described by before, a predicate that holds for
+    // a prefix of the sequence, and rank with their positions. The descent
+    // starts at the head, or at the finger when it is enabled.
+    template<typename Before>
+    void descend(Before cut, node** update, [[maybe_unused]] size_type* rank) const {
+        typename stats_type::probe probe;
+        auto before = [&](node* n) {
+            probe.compared();
+            return cut(n);
+        };
+        node* x = head();
+        int i = level - 1;
+        [[maybe_unused]] size_type pos = 0;
+        if (finger_enabled_) {
+            i = finger_entry(before);
+            x = finger_[i];
+            std::copy(finger_ + i + 1, finger_ + level, update + i + 1);
+            if constexpr (indexable) {
+                pos = finger_rank_[i];
+                std::copy(finger_rank_.begin() + i + 1, finger_rank_.begin() + level, rank + i + 1);
+            }
+        }
+        int top = i;
+        for (; i >= 0; --i) {
+            while (x->next(i) != head() && before(x->next(i))) {
+                if constexpr (indexable) {
+                    pos += x->width(i);
+                }
+                x = x->next(i);
+                probe.hopped(i);
+            }
+            update[i] = x;
+            if constexpr (indexable) {
+                rank[i] = pos;
+            }
+        }
+        if (finger_enabled_) {
+            std::copy(update, update + top + 1, finger_);
+            if constexpr (indexable) {
+                std::copy(rank, rank + top + 1, finger_rank_.begin());
+            }
+        }
+        stats_.searched(probe);
+    }
+
+    // Fills update and rank with the last node on each level before n.
+    // Equivalent elements ahead of n are passed over on level 0.
+    void path_to(node* n, node** update, size_type* rank) const {
+        descend([&](node* x) { return comp_(x->value, n->value); }, update, rank);
+        for (node* x = update[0]->next(0); x != n; x = x->next(0)) {
+            std::fill(update, update + x->height, x);
+            if constexpr (indexable) {
+                std::fill(rank, rank + x->height, rank[0] + 1);
+            }
+        }
+    }
+
+    // Fills update and rank with the last node on each level before the
+    // element at index r.
+    void descend_to_index(size_type r, node** update, size_type* rank) const noexcept
+        requires indexable
+    {
+        node* x = head();
+        size_type pos = 0;
+        for (int i = level - 1; i >= 0; --i) {
+            while (x->next(i) != head() && pos + x->width(i) <= r) {
+                pos += x->width(i);
+                x = x->next(i);
+            }
+            update[i] = x;
+            rank[i] = pos;
+        }
+    }
+
+    // Position of n, counted from 1. Smaller keys are skipped from the top
+    // and the rest of the way is walked on n's own top level.
+    size_type node_rank(node* n) const noexcept
+        requires indexable
+    {
+        node* x = head();
+        size_type pos = 0;
+        int top = n->height - 1;
+        for (int i = level - 1; i > top; --i) {
+            while (x->next(i) != head() && comp_(x->next(i)->value, n->value)) {
+                pos += x->width(i);
+                x = x->next(i);
+            }
+        }
+        while (x->next(top) != n) {
+            pos += x->width(top);
+            x = x->next(top);
+        }
+        return pos + x->width(top);
+    }
+
+    // Picks the level at which a finger search enters the list. Moving
+    // forward it climbs while the next node one level up is still before
+    // the cut; moving backward it climbs until the finger node itself is
+    // before the cut. Either way the climb is O(log d).
+    template<typename Before>
+    int finger_entry(Before before) const {
+        int j = 0;
+        if (finger_[0] == head() || before(finger_[0])) {
+            while (j + 1 < level && finger_[j + 1]->next(j + 1) != head() && before(finger_[j + 1]->next(j + 1))) {
+                ++j;
+            }
+            return j;
+        }
+        while (finger_[j] != head() && !before(finger_[j])) {
+            if (j + 1 == level) {
+                // Nothing on the finger is before the cut: enter at the head.
+                finger_[j] = head();
+                if constexpr (indexable) {
+                    finger_rank_[j] = 0;
+                }
+                return j;
+            }
+            ++j;
+        }
+        return j;
+    }
+
+    // Positions in front of the first element not less than key. K is T or
+    // a transparent lookup key.
+    template<typename K>
+    node* lower_bound_node(const K& key) const {
+        node* update[max_level];
+        rank_array rank;
+        descend([&](node* x) { return comp_(x->value, key); }, update, rank.data());
+        return update[0]->next(0);
+    }
+
+    template<typename K>
+    node* find_node(const K& key) const {
+        [[maybe_unused]] auto timer = stats_.time(stats_type::find_op);
+        node* n = lower_bound_node(key);
+        return n != head() && !comp_(key, n->value) ? n : head();
+    }
+
+    // A scan_iterator at lower_bound(key). The descent already passes the
+    // first node not less than key on every level, where the lookouts
+    // start.
+    template<typename K>
+    scan_iterator scan_at(const K& key) const {
+        node* update[max_level];
+        rank_array rank;
+        descend([&](node* x) { return comp_(x->value, key); }, update, rank.data());
+        std::array<node*, scan_levels> first;
+        for (int l = 1; l <= scan_levels; ++l) {
+            first[l - 1] = l < level ? update[l]->next(l) : head();
+        }
+        return scan_iterator(update[0]->next(0), first, head());
+    }
+
+    // An end position for a scan, with idle lookouts.
+    scan_iterator scan_end(node* x) const noexcept {
+        std::array<node*, scan_levels> idle;
+        idle.fill(head());
+        return scan_iterator(x, idle, head());
+    }
+
+    template<typename K, typename F>
+    void scan_each(const K& lo, const K& hi, F& f) const {
+        for (scan_iterator it = scan_at(lo); it.node_ != head() && comp_(*it, hi); ++it) {
+            std::invoke(f, *it);
+        }
+    }
+
+    template<typename K>
+    node* upper_bound_node(const K& key) const {
+        node* update[max_level];
+        rank_array rank;
+        descend([&](node* x) { return !comp_(key, x->value); }, update, rank.data());
+        return update[0]->next(0);
+    }
+
+    template<typename K>
+    jump_list_lookup<iterator> find_coroutine(K key) const {
+        node* x = head();
+        node* seen = head();
+        for (int i = level - 1; i >= 0; --i) {
+            for (node* nx = x->next(i); nx != head(); nx = x->next(i)) {
+                if (nx != seen) {
+                    jl_detail::prefetch(nx);
+                    co_await std::suspend_always{};
+                    seen = nx;
+                }
+                if (!comp_(nx->value, key)) {
+                    break;
+                }
+                x = nx;
+            }
+        }
+        node* n = x->next(0);
+        co_return iterator(n != head() && !comp_(key, n->value) ? n : head());
+    }
+
+    // Enough independent descents in flight to cover a DRAM miss with the
+    // hops of the others.
+    static constexpr size_type batch_lanes = 16;
+
+    // One run of sorted probes being resolved: the current probe, the node
+    // and level its descent has reached, and the predecessors found so far.
+    struct batch_lane {
+        size_type pos;
+        size_type end;
+        const T* key;
+        node* x;
+        int i;
+        node* update[max_level];
+    };
+
+    // Starts the descent for key from the lane's predecessors of the
+    // previous, not greater probe, climbing while the next node one level
+    // up is still before key.
+    void enter_lane(batch_lane& s, const T& key) const noexcept {
+        int j = 0;
+        while (j + 1 < level && s.update[j + 1]->next(j + 1) != head() &&
+               comp_(s.update[j + 1]->next(j + 1)->value, key)) {
+            ++j;
+        }
+        s.key = std::addressof(key);
+        s.x = s.update[j];
+        s.i = j;
+        jl_detail::prefetch(s.x->next(j));
+    }
+
+    // Calls visit(i, lower_bound_node(keys[i])) for every probe, in sorted
+    // probe order.
+    template<typename Visit>
+    void lower_bound_batch(std::span<const T> keys, Visit visit) const {
+        size_type m = keys.size();
+        std::vector<size_type> order(m);
+        std::iota(order.begin(), order.end(), size_type{0});
+        if (!std::is_sorted(keys.begin(), keys.end(), comp_)) {
+            std::sort(order.begin(), order.end(), [&](size_type a, size_type b) { return comp_(keys[a], keys[b]); });
+        }
+        size_type lanes = std::min(batch_lanes, m);
+        batch_lane lane[batch_lanes];
+        for (size_type l = 0; l < lanes; ++l) {
+            batch_lane& s = lane[l];
+            s.pos = m * l / lanes;
+            s.end = m * (l + 1) / lanes;
+            std::fill(std::begin(s.update), std::end(s.update), head());
+            enter_lane(s, keys[order[s.pos]]);
+        }
+        for (size_type active = lanes; active > 0;) {
+            for (size_type l = 0; l < lanes; ++l) {
+                batch_lane& s = lane[l];
+                if (s.pos == s.end) {
+                    continue;
+                }
+                node* nx = s.x->next(s.i);
+                if (nx != head() && comp_(nx->value, *s.key)) {
+                    s.x = nx;
+                } else if (s.i > 0) {
+                    s.update[s.i--] = s.x;
+                } else {
+                    s.update[0] = s.x;
+                    visit(order[s.pos], nx);
+                    if (++s.pos == s.end) {
+                        --active;
+                    } else {
+                        enter_lane(s, keys[order[s.pos]]);
+                    }
+                    continue;
+                }
+                jl_detail::prefetch(s.x->next(s.i));
+            }
+        }
+    }
+
+    template<typename... Args>
+    node* create_node(int height, Args&&... args) {
+        std::size_t bucket = static_cast<std::size_t>(height) - 1;
+        std::uint16_t slot;
+        node* n = ::new (pool_.allocate(bucket, slot)) node;
+        n->height = static_cast<std::int8_t>(height);
+        n->borrowed = false;
+        n->slot = slot;
+        try {
+            Allocator alloc(pool_.allocator());
+            alloc_traits::construct(alloc, std::addressof(n->value), std::forward<Args>(args)...);
+        } catch (...) {
+            n->~node();
+            pool_.deallocate(bucket, n, slot);
+            throw;
+        }
+        stats_.allocated();
+        return n;
+    }
+
+    bool can_adopt(const node_type& nh) const {
+        return alloc_traits::is_always_equal::value || *nh.alloc_ == get_allocator();
+    }
+
+    // Accounts for a node from a node_type that has just been linked in.
+    // Its block is reclaimed if it comes from this list's slabs and stays
+    // borrowed from its slab otherwise.
+    void take_in(node* n) noexcept {
+        n->borrowed = pool_.take_in(static_cast<std::size_t>(n->height) - 1, n, n->slot);
+        stats_.allocated();
+    }
+
+    void destroy_node(node* n) noexcept {
+        Allocator alloc(pool_.allocator());
+        alloc_traits::destroy(alloc, std::addressof(n->value));
+        free_node(n);
+        stats_.freed();
+        if (n == rebalance_cursor_) {
+            rebalance_cursor_ = nullptr;
+        }
+    }
+
+    // Returns the block of n, whose value is already destroyed, to this
+    // list's pool, or to its own slab if it is borrowed.
+    void free_node(node* n) noexcept {
+        std::size_t bucket = static_cast<std::size_t>(n->height) - 1;
+        std::uint16_t slot = n->slot;
+        bool borrowed = n->borrowed;
+        n->~node();
+        if (borrowed) {
+            pool_.return_borrowed(bucket, n, slot);
+        } else {
+            pool_.deallocate(bucket, n, slot);
+        }
+    }
+
+    // Elements equivalent to value are placed after the existing ones. The
+    // node is fully constructed before anything is linked, so a throwing
+    // constructor or comparison leaves the list untouched.
+    template<typename... Args>
+    iterator emplace_node(Args&&... args) {
+        [[maybe_unused]] auto timer = stats_.time(stats_type::insert_op);
+        node* n = create_node(random_level(), std::forward<Args>(args)...);
+        try {
+            return link_node(n);
+        } catch (...) {
+            destroy_node(n);
+            throw;
+        }
+    }
+
+    template<typename... Args>
+    iterator emplace_hint_node(node* hint, Args&&... args) {
+        [[maybe_unused]] auto timer = stats_.time(stats_type::insert_op);
+        node* n = create_node(random_level(), std::forward<Args>(args)...);
+        try {
+            return link_hinted(n, hint);
+        } catch (...) {
+            destroy_node(n);
+            throw;
+        }
+    }
+
+    // Links a node that is not in the list yet, keeping its height.
+    iterator link_node(node* n) {
+        node* update[max_level];
+        rank_array rank;
+        descend([&](node* x) { return !comp_(n->value, x->value); }, update, rank.data());
+        link_after(n, update, rank.data());
+        return iterator(n);
+    }
+
+    iterator link_hinted(node* n, node* hint)
+        requires backward_links
+    {
+        node* before = hint->prev;
+        bool fits = (before == head() || !comp_(n->value, before->value)) &&
+                    (hint == head() || !comp_(hint->value, n->value));
+        node* update[max_level];
+        rank_array rank;
+        if (!fits) {
+            return link_node(n);
+        }
+        if (finger_enabled_ && finger_[0] == before) {
+            std::copy(finger_, finger_ + level, update);
+            std::copy(finger_rank_.begin(), finger_rank_.begin() + (indexable ? level : 0), rank.begin());
+            link_after(n, update, rank.data());
+            return iterator(n);
+        }
+        if constexpr (indexable) {
+            // Every level's span changes, so the full path is needed; it is
+            // found by position.
+            descend_to_index(hint == head() ? size_ : node_rank(hint) - 1, update, rank.data());
+            link_after(n, update, rank.data());
+            return iterator(n);
+        }
+        if (finger_enabled_) {
+            // The full path leaves the finger right in front of hint, so a
+            // run of inserts at the same hint takes the branch above after
+            // this first one.
+            if (hint == head()) {
+                descend([](node*) { return true; }, update, rank.data());
+            } else {
+                path_to(hint, update, rank.data());
+            }
+            link_after(n, update, rank.data());
+            return iterator(n);
+        }
+        // The predecessor on level i is the nearest node before hint that
+        // is at least i + 1 high; the head stands in above them all. Only
+        // the levels n occupies are needed, one expected step back per
+        // level.
+        int filled = 0;
+        int need = std::min<int>(n->height, level);
+        for (node* x = before; filled < need; x = x->prev) {
+            int reach = x == head() ? need : std::min<int>(x->height, need);
+            while (filled < reach) {
+                update[filled++] = x;
+            }
+        }
+        link_after(n, update, rank.data());
+        return iterator(n);
+    }
+
+    // Without backward links the path to hint is found by a search, which
+    // also yields the predecessor to check.
+    iterator link_hinted(node* n, node* hint)
+        requires(!backward_links)
+    {
+        node* update[max_level];
+        rank_array rank;
+        if (hint == head()) {
+            descend([](node*) { return true; }, update, rank.data());
+        } else {
+            path_to(hint, update, rank.data());
+        }
+        node* before = update[0];
+        if ((before != head() && comp_(n->value, before->value)) ||
+            (hint != head() && comp_(hint->value, n->value))) {
+            return link_node(n);
+        }
+        link_after(n, update, rank.data());
+        return iterator(n);
+    }
+
+    // Links n right after update[i] on each of its levels, where update[i]
+    // is the last node on level i before the insertion point, and advances
+    // update to n so consecutive sorted insertions can reuse it. Indexable
+    // lists also split the spans on n's levels and widen those above it,
+    // for which update and rank must cover every level.
+    void link_after(node* n, node** update, [[maybe_unused]] size_type* rank) noexcept {
+        if (n->height > level) {
+            std::fill(update + level, update + n->height, head());
+            if constexpr (indexable) {
+                for (int i = level; i < n->height; ++i) {
+                    rank[i] = 0;
+                    head()->width(i) = size_ + 1;
+                }
+            }
+            level = n->height;
+        }
+        n->prev = update[0];
+        [[maybe_unused]] size_type r = 0;
+        if constexpr (indexable) {
+            r = rank[0] + 1;
+        }
+        for (int i = 0; i < n->height; ++i) {
+            n->next(i) = update[i]->next(i);
+            update[i]->next(i) = n;
+            if constexpr (indexable) {
+                size_type before = r - rank[i];
+                n->width(i) = update[i]->width(i) - before + 1;
+                update[i]->width(i) = before;
+                rank[i] = r;
+            }
+            update[i] = n;
+        }
+        if constexpr (indexable) {
+            for (int i = n->height; i < level; ++i) {
+                ++update[i]->width(i);
+            }
+        }
+        n->next(0)->prev = n;
+        ++size_;
+        if (finger_enabled_) {
+            std::copy(update, update + level, finger_);
+            if constexpr (indexable) {
+                std::copy(rank, rank + level, finger_rank_.begin());
+            }
+        }
+    }
+
+    // Puts m in place of n, whose predecessors on every level are in update
+    // (the head at and above level), and advances update to m. n is left
+    // unlinked but not destroyed.
+    void replace_node(node* n, node* m, node** update, [[maybe_unused]] size_type* rank) noexcept {
+        for (int i = 0; i < level; ++i) {
+            if (i < n->height) {
+                update[i]->next(i) = n->next(i);
+                if constexpr (indexable) {
+                    update[i]->width(i) += n->width(i) - 1;
+                }
+            } else if constexpr (indexable) {
+                --update[i]->width(i);
+            }
+        }
+        n->next(0)->prev = update[0];
+        --size_;
+        link_after(m, update, rank);
+        while (level > 1 && head()->next(level - 1) == head()) {
+            --level;
+        }
+    }
+
+    // Height of the k-th node (k >= 1) of a bulk build: countr_zero(k) + 1
+    // gives every second node two levels, every fourth three and so on, the
+    // shape of a perfectly balanced skip list.
+    static int balanced_height(size_type k) noexcept {
+        return std::min(std::countr_zero(k) + 1, max_level);
+    }
+
+    // Appends a range not less than the current last element. Heights go on
+    // from the current size, so successive appends, such as the chunks of
+    // load(), give the same towers as one bulk build.
+    template<typename It, typename Sent>
+    void append_sorted(It first, Sent last) {
+        node* update[max_level];
+        rank_array rank;
+        node* x = head();
+        [[maybe_unused]] size_type pos = 0;
+        for (int i = max_level - 1; i >= 0; --i) {
+            while (i < level && x->next(i) != head()) {
+                if constexpr (indexable) {
+                    pos += x->width(i);
+                }
+                x = x->next(i);
+            }
+            update[i] = x;
+            if constexpr (indexable) {
+                rank[i] = pos;
+            }
+        }
+        for (; first != last; ++first) {
+            link_after(create_node(balanced_height(size_ + 1), *first), update, rank.data());
+        }
+    }
+
+    // Walks level 0 once, recording for every level the last node passed,
+    // and links each new node in front of the first existing node greater
+    // than it.
+    template<typename It, typename Sent>
+    void merge_sorted(It first, Sent last) {
+        node* update[max_level];
+        rank_array rank{};
+        std::fill(std::begin(update), std::end(update), head());
+        node* x = head()->next(0);
+        auto skip_not_greater = [&](const T& value) {
+            while (x != head() && !comp_(value, x->value)) {
+                std::fill(update, update + x->height, x);
+                if constexpr (indexable) {
+                    std::fill(rank.begin(), rank.begin() + x->height, rank[0] + 1);
+                }
+                x = x->next(0);
+            }
+        };
+        for (size_type k = 1; first != last; ++first, ++k) {
+            if constexpr (yields_value<It>) {
+                auto&& value = *first;
+                skip_not_greater(value);
+                link_after(create_node(balanced_height(k), std::forward<decltype(value)>(value)), update,
+                           rank.data());
+            } else {
+                node* n = create_node(balanced_height(k), *first);
+                try {
+                    skip_not_greater(n->value);
+                } catch (...) {
+                    destroy_node(n);
+                    throw;
+                }
+                link_after(n, update, rank.data());
+            }
+        }
+    }
+
+    // Unlinks n from every level it occupies. Predecessors are found by
+    // skipping smaller keys first and then walking the run of equivalent
+    // keys until n itself is reached.
+    void unlink(node* n) noexcept {
+        if (n == rebalance_cursor_) {
+            rebalance_cursor_ = nullptr;
+        }
+        if constexpr (indexable) {
+            // Above n's height the link that spans n may start at an
+            // equivalent element, so the full path to n is needed.
+            node* update[max_level];
+            rank_array rank;
+            path_to(n, update, rank.data());
+            for (int i = 0; i < level; ++i) {
+                if (i < n->height) {
+                    update[i]->next(i) = n->next(i);
+                    update[i]->width(i) += n->width(i) - 1;
+                } else {
+                    --update[i]->width(i);
+                }
+            }
+            std::copy(update, update + level, finger_);
+            finger_rank_ = rank;
+        } else {
+            typename stats_type::probe probe;
+            node* x = head();
+            for (int i = level - 1; i >= 0; --i) {
+                while (x->next(i) != head() && (probe.compared(), comp_(x->next(i)->value, n->value))) {
+                    x = x->next(i);
+                    probe.hopped(i);
+                }
+                if (i < n->height) {
+                    while (x->next(i) != n) {
+                        x = x->next(i);
+                        probe.hopped(i);
+                    }
+                    x->next(i) = n->next(i);
+                }
+                finger_[i] = x;
+            }
+            stats_.searched(probe);
+        }
+        n->next(0)->prev = n->prev;
+        while (level > 1 && head()->next(level - 1) == head()) {
+            --level;
+        }
+        --size_;
+    }
+
+    // Also gives borrowed nodes back to their slabs, so only then does it
+    // visit trivially destructible elements.
+    void destroy_values() noexcept {
+        if (!std::is_trivially_destructible_v<T> || pool_.borrowed() != 0) {
+            Allocator alloc(pool_.allocator());
+            for (node* n = head()->next(0); n != head();) {
+                node* next = n->next(0);
+                alloc_traits::destroy(alloc, std::addressof(n->value));
+                if (n->borrowed) {
+                    free_node(n);
+                }
+                n = next;
+            }
+        }
+    }
+
+    // Takes the node structure of other, whose pool has already been
+    // transferred to this list, and leaves other empty. The last node on
+    // every level still points at other's head, so those links are
+    // retargeted with one descent from the top level.
+    void adopt_links(jump_list& other) noexcept {
+        if (other.size_ == 0) {
+            other.reset_head();
+            return;
+        }
+        node* old_head = other.head();
+        level = other.level;
+        size_ = other.size_;
+        for (int i = 0; i < level; ++i) {
+            head()->next(i) = old_head->next(i);
+            if constexpr (indexable) {
+                head()->width(i) = old_head->width(i);
+            }
+        }
+        head()->prev = old_head->prev;
+        head()->next(0)->prev = head();
+        node* x = head();
+        for (int i = level - 1; i >= 0; --i) {
+            while (x->next(i) != old_head) {
+                x = x->next(i);
+            }
+            x->next(i) = head();
+        }
+        other.reset_head();
+    }
+
+    // Destroys every element and returns its node to the pool's free list,
+    // keeping the slabs for the nodes that will replace them.
+    void recycle_nodes() noexcept {
+        for (node* n = head()->next(0); n != head();) {
+            node* next = n->next(0);
+            destroy_node(n);
+            n = next;
+        }
+        reset_head();
+    }
+
+    // Copies other into this empty list in one walk along level 0, giving
+    // every node the height of its original, so both lists end up with the
+    // same towers and no comparisons or level draws are made. A first pass
+    // over the heights reserves all the blocks up front, one slab per
+    // height at most.
+    void clone_from(const jump_list& other) {
+        std::array<size_type, max_level> heights{};
+        for (node* n = other.head()->next(0); n != other.head(); n = n->next(0)) {
+            ++heights[n->height - 1];
+        }
+        for (std::size_t b = 0; b < heights.size(); ++b) {
+            if (heights[b] != 0) {
+                pool_.reserve(b, heights[b]);
+            }
+        }
+        node* update[max_level];
+        rank_array rank{};
+        std::fill(std::begin(update), std::end(update), head());
+        for (node* n = other.head()->next(0); n != other.head(); n = n->next(0)) {
+            link_after(create_node(n->height, n->value), update, rank.data());
+        }
+    }
+
+    // Appends copies of [first, last) to dst, an empty list with the same
+    // allocator, keeping their tower heights. Values are moved when that
+    // cannot throw.
+    void transfer_run(jump_list& dst, node* first, node* last) {
+        node* update[max_level];
+        rank_array rank{};
+        std::fill(std::begin(update), std::end(update), dst.head());
+        for (node* n = first; n != last; n = n->next(0)) {
+            dst.link_after(dst.create_node(n->height, std::move_if_noexcept(n->value)), update, rank.data());
+        }
+    }
+
+    // Moves update, the last node on every level before some position, on
+    // to the first node that fails before, which must not lie behind that
+    // position. The search climbs from level 0 only as high as the distance
+    // requires and comes back down, O(log d) for a node d positions on.
+    template<typename Before>
+    void finger_advance(node** update, Before before) const {
+        int top = 0;
+        while (top + 1 < level && update[top + 1]->next(top + 1) != head() &&
+               before(update[top + 1]->next(top + 1))) {
+            ++top;
+        }
+        node* x = update[top];
+        bool moved = false;
+        for (int i = top; i >= 0; --i) {
+            // Until the search moves, the old path is further along.
+            if (!moved) {
+                x = update[i];
+            }
+            while (x->next(i) != head() && before(x->next(i))) {
+                x = x->next(i);
+                moved = true;
+            }
+            update[i] = x;
+        }
+    }
+
+    // Walks this list and other side by side for the set operations.
+    // Elements of this list found only here, elements of other found only
+    // there, and elements found in both (taken from this list, matched one
+    // for one) are kept or dropped as the flags say. Runs of elements that
+    // only one list holds are skipped with finger_advance().
+    template<bool KeepOwn, bool KeepCommon, bool KeepOther>
+    jump_list combine(const jump_list& other) const {
+        jump_list out(comp_, get_allocator());
+        node* tail[max_level];
+        rank_array rank{};
+        std::fill(std::begin(tail), std::end(tail), out.head());
+        auto emit = [&](node* from, node* to) {
+            for (; from != to; from = from->next(0)) {
+                out.link_after(out.create_node(balanced_height(out.size_ + 1), from->value), tail, rank.data());
+            }
+        };
+        node* path[max_level];
+        node* other_path[max_level];
+        std::fill(std::begin(path), std::end(path), head());
+        std::fill(std::begin(other_path), std::end(other_path), other.head());
+        node* x = head()->next(0);
+        node* y = other.head()->next(0);
+        while (x != head() && y != other.head()) {
+            if (comp_(x->value, y->value)) {
+                finger_advance(path, [&](node* n) { return comp_(n->value, y->value); });
+                node* next = path[0]->next(0);
+                if constexpr (KeepOwn) {
+                    emit(x, next);
+                }
+                x = next;
+            } else if (comp_(y->value, x->value)) {
+                other.finger_advance(other_path, [&](node* n) { return comp_(n->value, x->value); });
+                node* next = other_path[0]->next(0);
+                if constexpr (KeepOther) {
+                    emit(y, next);
+                }
+                y = next;
+            } else {
+                if constexpr (KeepCommon) {
+                    emit(x, x->next(0));
+                }
+                std::fill(path, path + x->height, x);
+                std::fill(other_path, other_path + y->height, y);
+                x = x->next(0);
+                y = y->next(0);
+            }
+        }
+        if constexpr (KeepOwn) {
+            emit(x, head());
+        }
+        if constexpr (KeepOther) {
+            emit(y, other.head());
+        }
+        return out;
+    }
+
+    // The last element, or the head if the list is empty. Without backward
+    // links this takes a descent along the right edge of the towers.
+    node* last_node() const noexcept {
+        if constexpr (backward_links) {
+            return head()->prev;
+        } else {
+            node* x = head();
+            for (int i = level - 1; i >= 0; --i) {
+                while (x->next(i) != head()) {
+                    x = x->next(i);
+                }
+            }
+            return x;
+        }
+    }
+
+    // Last node on every level, the head on levels at or above level, and
+    // their positions.
+    void last_nodes(node** last, size_type* rank) const noexcept {
+        node* x = head();
+        [[maybe_unused]] size_type pos = 0;
+        for (int i = max_level - 1; i >= 0; --i) {
+            while (i < level && x->next(i) != head()) {
+                if constexpr (indexable) {
+                    pos += x->width(i);
+                }
+                x = x->next(i);
+            }
+            last[i] = x;
+            if constexpr (indexable) {
+                rank[i] = pos;
+            }
+        }
+    }
+
+    // The next three take the nodes of other, whose slabs already belong to
+    // this list's pool, and leave other empty. Both lists are non-empty.
+
+    // Every element of other sorts after every element here: the towers of
+    // other continue where this list's towers end.
+    void append_links(jump_list& other) noexcept {
+        node* last[max_level];
+        node* other_last[max_level];
+        rank_array rank;
+        rank_array other_rank;
+        last_nodes(last, rank.data());
+        other.last_nodes(other_last, other_rank.data());
+        for (int i = 0; i < other.level; ++i) {
+            if constexpr (indexable) {
+                last[i]->width(i) = size_ - rank[i] + other.head()->width(i);
+            }
+            last[i]->next(i) = other.head()->next(i);
+            other_last[i]->next(i) = head();
+        }
+        if constexpr (indexable) {
+            for (int i = other.level; i < level; ++i) {
+                last[i]->width(i) += other.size_;
+            }
+        }
+        other.head()->next(0)->prev = head()->prev;
+        head()->prev = other.head()->prev;
+        level = std::max(level, other.level);
+        size_ += other.size_;
+        reset_finger();
+        other.reset_head();
+    }
+
+    // Every element of other sorts before every element here.
+    void prepend_links(jump_list& other) noexcept {
+        node* other_last[max_level];
+        rank_array other_rank;
+        other.last_nodes(other_last, other_rank.data());
+        head()->next(0)->prev = other.head()->prev;
+        for (int i = 0; i < other.level; ++i) {
+            if constexpr (indexable) {
+                size_type first_rank = i < level ? head()->width(i) : size_ + 1;
+                other_last[i]->width(i) = other.size_ + first_rank - other_rank[i];
+                head()->width(i) = other.head()->width(i);
+            }
+            other_last[i]->next(i) = head()->next(i);
+            head()->next(i) = other.head()->next(i);
+        }
+        if constexpr (indexable) {
+            for (int i = other.level; i < level; ++i) {
+                head()->width(i) += other.size_;
+            }
+        }
+        head()->next(0)->prev = head();
+        level = std::max(level, other.level);
+        size_ += other.size_;
+        reset_finger();
+        other.reset_head();
+    }
+
+    // Points update (and rank) at the place after the elements equivalent
+    // to value. On each level the search starts from whichever is further
+    // along: the node reached on the level above or the previous insertion
+    // point left in update, which must not lie past value's place.
+    void resume_search(const T& value, node** update, [[maybe_unused]] size_type* rank) {
+        node* x = head();
+        [[maybe_unused]] size_type pos = 0;
+        for (int i = level - 1; i >= 0; --i) {
+            if (x == head() || (update[i] != head() && !comp_(update[i]->value, x->value))) {
+                x = update[i];
+                if constexpr (indexable) {
+                    pos = rank[i];
+                }
+            }
+            while (x->next(i) != head() && !comp_(value, x->next(i)->value)) {
+                if constexpr (indexable) {
+                    pos += x->width(i);
+                }
+                x = x->next(i);
+            }
+            update[i] = x;
+            if constexpr (indexable) {
+                rank[i] = pos;
+            }
+        }
+    }
+
+    // Whether It yields T itself. The sorted merges then search with the
+    // source element before its node is built, so a throwing comparator
+    // leaves it unconsumed, which buffered_jump_list::flush() counts on;
+    // otherwise the node built first is destroyed if the search throws.
+    template<typename It>
+    static constexpr bool yields_value = std::same_as<std::remove_cvref_t<std::iter_reference_t<It>>, T>;
+
+    // Inserts a sorted range one element at a time, each search resuming
+    // from the previous insertion point, so m elements spread over the list
+    // cost O(m log(n / m)) rather than O(m log n). Heights are drawn as by
+    // emplace: a bulk build would cap them at the height of an m-element
+    // list.
+    template<typename It, typename Sent>
+    void link_sorted(It first, Sent last) {
+        node* update[max_level];
+        rank_array rank{};
+        std::fill(std::begin(update), std::end(update), head());
+        for (; first != last; ++first) {
+            if constexpr (yields_value<It>) {
+                auto&& value = *first;
+                resume_search(value, update, rank.data());
+                link_after(create_node(random_level(), std::forward<decltype(value)>(value)), update, rank.data());
+            } else {
+                node* n = create_node(random_level(), *first);
+                try {
+                    resume_search(n->value, update, rank.data());
+                } catch (...) {
+                    destroy_node(n);
+                    throw;
+                }
+                link_after(n, update, rank.data());
+            }
+        }
+    }
+
+    // The ranges overlap, so other's nodes are linked in one at a time.
+    void relink_from(jump_list& other) {
+        node* update[max_level];
+        rank_array rank{};
+        std::fill(std::begin(update), std::end(update), head());
+        node* other_head = other.head();
+        node* n = other_head->next(0);
+        try {
+            while (n != other_head) {
+                resume_search(n->value, update, rank.data());
+                node* next = n->next(0);
+                link_after(n, update, rank.data());
+                n = next;
+            }
+        } catch (...) {
+            // The remaining nodes already live in this list's pool, so other
+            // cannot take them back; they are destroyed instead.
+            while (n != other_head) {
+                destroy_node(std::exchange(n, n->next(0)));
+            }
+            other.reset_head();
+            throw;
+        }
+        other.reset_head();
+    }
+
+    void move_elements_from(jump_list& other) {
+        for (node* n = other.head()->next(0); n != other.head(); n = n->next(0)) {
+            emplace_node(std::move(n->value));
+        }
+        other.clear();
+    }
+
+    // Exchanges contents, comparator and (if PropagateAlloc) allocator.
+    // Node structures are relinked to the other head; no element moves.
+    template<bool PropagateAlloc>
+    void swap_storage(jump_list& other) noexcept(std::is_nothrow_swappable_v<Compare>) {
+        using std::swap;
+        swap(comp_, other.comp_);
+        swap(levels_, other.levels_);
+        swap(finger_enabled_, other.finger_enabled_);
+        jump_list parked(std::move(*this));
+        pool_.template take<PropagateAlloc>(other.pool_);
+        adopt_links(other);
+        other.pool_.template take<PropagateAlloc>(parked.pool_);
+        other.adopt_links(parked);
+    }
+
+    [[no_unique_address]] Compare comp_;
+    pool_type pool_;
+    // Sentinel laid out like a node of height max_level; its value is never
+    // constructed.
+    alignas(node) unsigned char head_storage_[sizeof(node) + max_level * sizeof(link)];
     int level;
     size_t size_;
-    // TODO
+    // Per-level predecessors left by the last operation; entries at or above
+    // level are the head. Only maintained while finger_enabled_ is set.
+    mutable node* finger_[max_level];
+    [[no_unique_address]] mutable rank_array finger_rank_{};
+    bool finger_enabled_ = false;
+    [[no_unique_address]] level_policy levels_;
+    [[no_unique_address]] mutable stats_type stats_;
+    // Where the next rebalance() resumes; cleared when that node leaves.
+    node* rebalance_cursor_ = nullptr;
 };
 
-#endif // JUMP_LIST_H
\ No newline at end of file
+template<std::input_iterator It, typename Compare = std::less<std::iter_value_t<It>>,
+         typename Allocator = std::allocator<std::iter_value_t<It>>>
+jump_list(It, It, Compare = Compare(), Allocator = Allocator())
+    -> jump_list<std::iter_value_t<It>, Compare, Allocator>;
+
+#include "jump_list_fat.h"
+#include "jump_list_compact.h"
+
+#endif // JUMP_LIST_H
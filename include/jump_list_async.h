@@ -0,0 +1,100 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+#ifndef JUMP_LIST_ASYNC_H
+#define JUMP_LIST_ASYNC_H
+
+#include "jump_list.h"
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Interleaves lookups that arrive one at a time (AMAC style). Each key
+// handed to submit() becomes a find_async() coroutine; the scheduler
+// resumes the lookups in flight in turn, one hop each, so while one waits
+// for the node it prefetched the others make progress. When a lookup
+// finishes, on_done(tag, it) receives the tag it was submitted with and
+// the iterator find() would return. Results therefore come back out of
+// order, from within submit(), poll() or drain().
+//
+// The list must outlive the scheduler and must not be modified while
+// lookups are in flight. A throwing comparator or callback propagates out
+// of the call that ran it; the other lookups stay in flight.
+template<typename List, typename Callback>
+    requires std::invocable<Callback&, std::size_t, typename List::const_iterator>
+class lookup_scheduler {
+    using task = jump_list_lookup<typename List::iterator>;
+
+public:
+    using key_type = typename List::key_type;
+    using size_type = std::size_t;
+
+    // Enough lookups to cover a DRAM miss with the hops of the others,
+    // while their frames stay in L1.
+    static constexpr size_type default_width = 32;
+
+    explicit lookup_scheduler(const List& list, Callback on_done, size_type width = default_width)
+        : list_(list), on_done_(std::move(on_done)), width_(width != 0 ? width : 1) {
+        slots_.reserve(width_);
+    }
+
+    // Starts a lookup of key, first advancing those in flight until one
+    // finishes if width() of them are running.
+    void submit(const key_type& key, size_type tag) {
+        while (slots_.size() == width_) {
+            step();
+        }
+        slots_.push_back({list_.find_async(key), tag});
+    }
+
+    // Advances every lookup in flight by one hop. Returns how many are
+    // still in flight.
+    size_type poll() {
+        step();
+        return slots_.size();
+    }
+
+    // Runs every lookup in flight to completion.
+    void drain() {
+        while (!slots_.empty()) {
+            step();
+        }
+    }
+
+    size_type in_flight() const noexcept { return slots_.size(); }
+    size_type width() const noexcept { return width_; }
+
+private:
+    struct slot {
+        task lookup;
+        size_type tag;
+    };
+
+    void step() {
+        for (size_type i = 0; i < slots_.size();) {
+            slots_[i].lookup.resume();
+            if (!slots_[i].lookup.done()) {
+                ++i;
+                continue;
+            }
+            // The slot is freed before the callback runs, so a throwing
+            // get() or callback leaves the scheduler consistent.
+            slot finished = std::move(slots_[i]);
+            if (i + 1 != slots_.size()) {
+                slots_[i] = std::move(slots_.back());
+            }
+            slots_.pop_back();
+            std::invoke(on_done_, finished.tag, finished.lookup.get());
+        }
+    }
+
+    const List& list_;
+    Callback on_done_;
+    size_type width_;
+    std::vector<slot> slots_;
+};
+
+#endif // JUMP_LIST_ASYNC_H
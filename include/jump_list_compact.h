@@ -0,0 +1,620 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+#ifndef JUMP_LIST_COMPACT_H
+#define JUMP_LIST_COMPACT_H
+
+#include "jump_list.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Compact jump_list: nodes live in one contiguous arena and refer to each
+// other by 32-bit word offsets into it instead of pointers. A node of height
+// h costs its element plus 4h + 8 bytes rather than 8h + 16, so the
+// per-node overhead roughly halves, and a copy of the list is one copy of
+// the arena.
+//
+// The price is address stability. The arena grows by reallocation, so T
+// must be trivially copyable, and inserting may invalidate references and
+// pointers to elements. Iterators hold an offset, not an address: they stay
+// valid until their element is erased, but not across swap() or a move.
+// The arena is capped at 2^32 words of 4 bytes, which for small elements is
+// several hundred million nodes; an insertion past that throws
+// std::length_error. Erased nodes go on per-height free lists and are
+// reused, but the arena never shrinks short of clear().
+template<typename T, typename Compare, typename Allocator, typename Traits>
+    requires jump_list_comparator<Compare, T> && (Traits::keys_per_node == 1) && (Traits::compact_links)
+class jump_list<T, Compare, Allocator, Traits> {
+    static_assert(std::is_trivially_copyable_v<T>, "compact links need a trivially copyable element type");
+    static_assert(!Traits::indexable, "compact links do not support indexable_traits");
+    static_assert(Traits::max_level >= 1 && Traits::max_level <= jl_detail::max_level,
+                  "max_level must lie in [1, jl_detail::max_level]");
+
+    using index = std::uint32_t;
+
+    // Nodes start on a multiple of align_words, so every element is aligned.
+    // The node at offset x holds its element, then prev, height and
+    // next(0) to next(height - 1).
+    static constexpr index align_words = std::max<index>(alignof(T) / sizeof(index), 1);
+    static constexpr index value_words =
+        (static_cast<index>((sizeof(T) + sizeof(index) - 1) / sizeof(index)) + align_words - 1) / align_words *
+        align_words;
+    static constexpr index prev_word = value_words;
+    static constexpr index height_word = value_words + 1;
+    static constexpr index next_word = value_words + 2;
+
+    // The head sits at offset 0, which also ends every free list.
+    static constexpr index head = 0;
+    static constexpr std::uint64_t max_words = std::uint64_t{1} << 32;
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using unit = jl_detail::storage_unit<align_words * sizeof(index)>;
+    using unit_allocator = typename alloc_traits::template rebind_alloc<unit>;
+    using level_policy = typename Traits::level_policy;
+
+    static constexpr int max_level = Traits::max_level;
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = typename alloc_traits::pointer;
+    using const_pointer = typename alloc_traits::const_pointer;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() noexcept = default;
+
+        reference operator*() const noexcept { return owner_->element(x_); }
+        pointer operator->() const noexcept { return std::addressof(owner_->element(x_)); }
+
+        const_iterator& operator++() noexcept {
+            x_ = owner_->next(x_, 0);
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        const_iterator& operator--() noexcept {
+            x_ = owner_->prev(x_);
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept {
+            const_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        friend bool operator==(const const_iterator&, const const_iterator&) = default;
+
+    private:
+        friend class jump_list;
+
+        const_iterator(const jump_list* owner, index x) noexcept : owner_(owner), x_(x) {}
+
+        const jump_list* owner_ = nullptr;
+        index x_ = head;
+    };
+
+    using iterator = const_iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // Construction and destruction
+
+    jump_list() : jump_list(Compare()) {}
+
+    explicit jump_list(const Compare& comp, const Allocator& alloc = Allocator())
+        : comp_(comp), arena_(unit_allocator(alloc)) {}
+
+    explicit jump_list(const Allocator& alloc) : jump_list(Compare(), alloc) {}
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    jump_list(It first, It last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : jump_list(comp, alloc) {
+        insert(first, last);
+    }
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    jump_list(It first, It last, const Allocator& alloc) : jump_list(first, last, Compare(), alloc) {}
+
+    // Builds balanced towers over [first, last), which must be sorted by
+    // comp, in one linear pass.
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    jump_list(sorted_equivalent_t, It first, It last, const Compare& comp = Compare(),
+              const Allocator& alloc = Allocator())
+        : jump_list(comp, alloc) {
+        append_sorted(first, last);
+    }
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    jump_list(sorted_equivalent_t, It first, It last, const Allocator& alloc)
+        : jump_list(sorted_equivalent, first, last, Compare(), alloc) {}
+
+    jump_list(std::initializer_list<T> init, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : jump_list(comp, alloc) {
+        insert(init);
+    }
+
+    jump_list(std::initializer_list<T> init, const Allocator& alloc) : jump_list(init, Compare(), alloc) {}
+
+    // Offsets are relative to the arena, so copying it copies the towers.
+    jump_list(const jump_list& other)
+        : jump_list(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+    jump_list(const jump_list& other, const Allocator& alloc)
+        : comp_(other.comp_), arena_(other.arena_, unit_allocator(alloc)), free_(other.free_), level(other.level),
+          size_(other.size_) {}
+
+    jump_list(jump_list&& other) noexcept
+        : comp_(other.comp_), arena_(std::move(other.arena_)), free_(other.free_), level(other.level),
+          size_(other.size_), levels_(other.levels_) {
+        other.clear();
+    }
+
+    jump_list(jump_list&& other, const Allocator& alloc)
+        : comp_(other.comp_), arena_(std::move(other.arena_), unit_allocator(alloc)), free_(other.free_),
+          level(other.level), size_(other.size_) {
+        other.clear();
+    }
+
+    ~jump_list() = default;
+
+    jump_list& operator=(const jump_list& other) {
+        if (this != &other) {
+            arena_ = other.arena_;
+            comp_ = other.comp_;
+            free_ = other.free_;
+            level = other.level;
+            size_ = other.size_;
+        }
+        return *this;
+    }
+
+    jump_list& operator=(jump_list&& other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) {
+        if (this != &other) {
+            arena_ = std::move(other.arena_);
+            comp_ = other.comp_;
+            free_ = other.free_;
+            level = other.level;
+            size_ = other.size_;
+            other.clear();
+        }
+        return *this;
+    }
+
+    jump_list& operator=(std::initializer_list<T> init) {
+        return *this = jump_list(init, comp_, get_allocator());
+    }
+
+    allocator_type get_allocator() const noexcept { return allocator_type(arena_.get_allocator()); }
+
+    // Iterators
+
+    iterator begin() const noexcept { return iterator(this, arena_.empty() ? head : next(head, 0)); }
+    iterator end() const noexcept { return iterator(this, head); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    reverse_iterator rbegin() const noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() const noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    size_type size() const noexcept { return size_; }
+    size_type max_size() const noexcept { return static_cast<size_type>(max_words / node_words(1)) - 1; }
+
+    // Bytes held by the arena, free nodes and spare capacity included.
+    size_type arena_bytes() const noexcept { return arena_.capacity() * sizeof(unit); }
+
+    // Modifiers
+
+    // Keeps the arena's capacity for the elements to come.
+    void clear() noexcept {
+        arena_.clear();
+        free_.fill(head);
+        level = 1;
+        size_ = 0;
+    }
+
+    // The element goes after its equivalents.
+    iterator insert(const T& value) {
+        // Copied first: value may live in the arena, which create_node() can
+        // move.
+        T v = value;
+        make_head();
+        index update[max_level];
+        descend([&](const T& x) { return !comp_(v, x); }, update);
+        index n = create_node(random_level());
+        std::construct_at(std::addressof(element(n)), v);
+        link_after(n, update);
+        ++size_;
+        return iterator(this, n);
+    }
+
+    // Elements are stored by value in the arena, so these build the element
+    // first and insert it. The hint is not used.
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    iterator emplace(Args&&... args) {
+        return insert(T(std::forward<Args>(args)...));
+    }
+
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    iterator emplace_hint(const_iterator, Args&&... args) {
+        return insert(T(std::forward<Args>(args)...));
+    }
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    void insert(It first, It last) {
+        if constexpr (std::forward_iterator<It> && std::same_as<std::iter_value_t<It>, T>) {
+            if (size_ == 0 && std::is_sorted(first, last, comp_)) {
+                append_sorted(first, last);
+                return;
+            }
+        }
+        for (; first != last; ++first) {
+            insert(T(*first));
+        }
+    }
+
+    void insert(std::initializer_list<T> init) { insert(init.begin(), init.end()); }
+
+    iterator erase(const_iterator pos) {
+        index n = pos.x_;
+        index after = next(n, 0);
+        unlink(n);
+        destroy_node(n);
+        --size_;
+        return iterator(this, after);
+    }
+
+    // Offsets survive the erasure of other nodes, so last stays valid.
+    iterator erase(const_iterator first, const_iterator last) {
+        while (first != last) {
+            first = erase(first);
+        }
+        return first;
+    }
+
+    size_type erase(const T& key) {
+        auto [first, last] = equal_range(key);
+        size_type n = 0;
+        for (; first != last; ++n) {
+            first = erase(first);
+        }
+        return n;
+    }
+
+    void swap(jump_list& other) noexcept(std::is_nothrow_swappable_v<Compare>) {
+        using std::swap;
+        swap(comp_, other.comp_);
+        arena_.swap(other.arena_);
+        swap(free_, other.free_);
+        swap(level, other.level);
+        swap(size_, other.size_);
+        swap(levels_, other.levels_);
+    }
+
+    friend void swap(jump_list& a, jump_list& b) noexcept(noexcept(a.swap(b))) { a.swap(b); }
+
+    // Lookup
+
+    size_type count(const T& key) const {
+        auto [first, last] = equal_range(key);
+        return static_cast<size_type>(std::distance(first, last));
+    }
+
+    iterator find(const T& key) const { return find_at(key); }
+
+    bool contains(const T& key) const { return find(key) != end(); }
+
+    iterator lower_bound(const T& key) const { return bound_at<false>(key); }
+    iterator upper_bound(const T& key) const { return bound_at<true>(key); }
+
+    std::pair<iterator, iterator> equal_range(const T& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // Heterogeneous lookup for transparent comparators, as in the plain
+    // layout.
+
+    template<jump_list_lookup_key<Compare, T> K>
+    size_type count(const K& key) const {
+        auto [first, last] = equal_range(key);
+        return static_cast<size_type>(std::distance(first, last));
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator find(const K& key) const {
+        return find_at(key);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    bool contains(const K& key) const {
+        return find(key) != end();
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator lower_bound(const K& key) const {
+        return bound_at<false>(key);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator upper_bound(const K& key) const {
+        return bound_at<true>(key);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    std::pair<iterator, iterator> equal_range(const K& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // Parallel iteration
+
+    // Cuts the list into at most n non-empty, contiguous subranges, picked
+    // as in the plain layout from the highest level with at least
+    // n log2(size) nodes.
+    std::vector<std::ranges::subrange<const_iterator>> partition(size_type n) const {
+        std::vector<std::ranges::subrange<const_iterator>> parts;
+        if (n == 0 || size_ == 0) {
+            return parts;
+        }
+        std::vector<index> row;
+        auto wanted = n * static_cast<size_type>(std::bit_width(size_));
+        for (int i = level - 1; i >= 0 && row.size() < wanted; --i) {
+            row.clear();
+            for (index x = next(head, i); x != head; x = next(x, i)) {
+                row.push_back(x);
+            }
+        }
+        n = std::min(n, row.size());
+        index from = next(head, 0);
+        for (size_type j = 1; j <= n; ++j) {
+            index to = j == n ? head : row[row.size() * j / n];
+            parts.emplace_back(iterator(this, from), iterator(this, to));
+            from = to;
+        }
+        return parts;
+    }
+
+    // Serialization
+
+    // Writes the same snapshot format as the other layouts; see the plain
+    // layout's save(). Throws std::runtime_error if the stream fails.
+    void save(std::ostream& os) const {
+        jl_detail::save_snapshot(os, *this);
+    }
+
+    // Reads a snapshot written by any layout's save(), as the plain
+    // layout's load() does, building the nodes chunk by chunk.
+    void load(std::istream& is) {
+        jl_detail::load_snapshot(
+            is, *this, [this](auto first, auto last) { append_sorted(first, last); },
+            [this]() -> const T& { return *std::prev(end()); });
+    }
+
+    // Observers
+
+    key_compare key_comp() const { return comp_; }
+    value_compare value_comp() const { return comp_; }
+
+    // Comparison
+
+    friend bool operator==(const jump_list& a, const jump_list& b) {
+        return a.size_ == b.size_ && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    friend auto operator<=>(const jump_list& a, const jump_list& b) {
+        return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end(),
+                                                      jl_detail::synth_three_way{});
+    }
+
+private:
+    static constexpr index node_words(int height) noexcept {
+        return (next_word + static_cast<index>(height) + align_words - 1) / align_words * align_words;
+    }
+
+    index* words() const noexcept { return reinterpret_cast<index*>(const_cast<unit*>(arena_.data())); }
+
+    static const T& element_in(const index* w, index x) noexcept {
+        return *std::launder(reinterpret_cast<const T*>(w + x));
+    }
+
+    T& element(index x) const noexcept { return *std::launder(reinterpret_cast<T*>(words() + x)); }
+    index& next(index x, int i) const noexcept { return words()[x + next_word + i]; }
+    index& prev(index x) const noexcept { return words()[x + prev_word]; }
+    int height(index x) const noexcept { return static_cast<int>(words()[x + height_word]); }
+
+    // Capped by the element count, as in the plain layout.
+    int random_level() { return levels_(std::min(static_cast<int>(std::bit_width(size_)) + 1, max_level)); }
+
+    // Creates the head at offset 0 the first time an element arrives. The
+    // arena grows zero-filled, so its links already point to itself.
+    void make_head() {
+        if (arena_.empty()) {
+            arena_.resize(node_words(max_level) / align_words);
+            words()[head + height_word] = max_level;
+        }
+    }
+
+    // Fills update[0, level) with the last node on each level whose element
+    // satisfies before and returns the one on level 0. The arena is read
+    // through one base pointer, as nothing can move it during a search.
+    template<typename Before>
+    index descend(Before before, index* update) const {
+        const index* w = words();
+        index x = head;
+        for (int i = level - 1; i >= 0; --i) {
+            for (index nx = w[x + next_word + i]; nx != head && before(element_in(w, nx));
+                 nx = w[x + next_word + i]) {
+                x = nx;
+            }
+            update[i] = x;
+        }
+        return x;
+    }
+
+    // lower_bound with Upper false, upper_bound with it set. K is T or a
+    // transparent lookup key.
+    template<bool Upper, typename K>
+    iterator bound_at(const K& key) const {
+        if (size_ == 0) {
+            return end();
+        }
+        index update[max_level];
+        index x;
+        if constexpr (Upper) {
+            x = descend([&](const T& v) { return !comp_(key, v); }, update);
+        } else {
+            x = descend([&](const T& v) { return comp_(v, key); }, update);
+        }
+        return iterator(this, next(x, 0));
+    }
+
+    template<typename K>
+    iterator find_at(const K& key) const {
+        iterator it = bound_at<false>(key);
+        return it != end() && !comp_(key, *it) ? it : end();
+    }
+
+    // Takes a node from the free list of its height, or from the end of the
+    // arena, which may move every element.
+    index create_node(int height) {
+        index& free = free_[static_cast<std::size_t>(height) - 1];
+        if (free != head) {
+            index x = free;
+            free = prev(x);
+            return x;
+        }
+        std::uint64_t x = arena_.size() * align_words;
+        std::uint64_t end = x + node_words(height);
+        if (end > max_words) {
+            throw std::length_error("jump_list: compact arena exhausted");
+        }
+        arena_.resize(static_cast<std::size_t>(end / align_words));
+        words()[x + height_word] = static_cast<index>(height);
+        return static_cast<index>(x);
+    }
+
+    // Freed nodes keep their height and chain through prev.
+    void destroy_node(index n) noexcept {
+        index& free = free_[static_cast<std::size_t>(height(n)) - 1];
+        prev(n) = free;
+        free = n;
+    }
+
+    // Links n right after update[i] on each of its levels and advances
+    // update to n.
+    void link_after(index n, index* update) noexcept {
+        int h = height(n);
+        if (h > level) {
+            std::fill(update + level, update + h, head);
+            level = h;
+        }
+        prev(n) = update[0];
+        for (int i = 0; i < h; ++i) {
+            next(n, i) = next(update[i], i);
+            next(update[i], i) = n;
+            update[i] = n;
+        }
+        prev(next(n, 0)) = n;
+    }
+
+    // Unlinks n from every level, finding its predecessors by its element
+    // and then by offset among its equivalents.
+    void unlink(index n) noexcept {
+        const T& v = element(n);
+        index x = head;
+        for (int i = level - 1; i >= 0; --i) {
+            while (next(x, i) != head && comp_(element(next(x, i)), v)) {
+                x = next(x, i);
+            }
+            if (i < height(n)) {
+                while (next(x, i) != n) {
+                    x = next(x, i);
+                }
+                next(x, i) = next(n, i);
+            }
+        }
+        prev(next(n, 0)) = prev(n);
+        while (level > 1 && next(head, level - 1) == head) {
+            --level;
+        }
+    }
+
+    // Height of the k-th node (k >= 1) of a bulk build, as in the plain
+    // layout.
+    static int balanced_height(size_type k) noexcept {
+        return std::min(std::countr_zero(k) + 1, max_level);
+    }
+
+    // Appends a range not less than the current last element. Heights go on
+    // from the current size.
+    template<typename It, typename Sent>
+    void append_sorted(It first, Sent last) {
+        if (first == last) {
+            return;
+        }
+        make_head();
+        index update[max_level];
+        index x = head;
+        for (int i = max_level - 1; i >= 0; --i) {
+            while (i < level && next(x, i) != head) {
+                x = next(x, i);
+            }
+            update[i] = x;
+        }
+        for (size_type k = size_ + 1; first != last; ++first, ++k) {
+            T v(*first);
+            index n = create_node(balanced_height(k));
+            std::construct_at(std::addressof(element(n)), v);
+            link_after(n, update);
+            ++size_;
+        }
+    }
+
+    [[no_unique_address]] Compare comp_;
+    std::vector<unit, unit_allocator> arena_;
+    // Heads of the free lists, one per tower height.
+    std::array<index, max_level> free_{};
+    int level = 1;
+    size_type size_ = 0;
+    [[no_unique_address]] level_policy levels_;
+};
+
+#endif // JUMP_LIST_COMPACT_H
@@ -0,0 +1,1064 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+#ifndef JUMP_LIST_FAT_H
+#define JUMP_LIST_FAT_H
+
+#include "jump_list.h"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define JUMP_LIST_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define JUMP_LIST_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace jl_detail {
+
+// Vector instruction set used for in-node key search, detected once at
+// runtime on x86 and fixed at compile time elsewhere.
+enum class simd_isa { scalar, sse42, avx2, neon };
+
+inline simd_isa detect_simd_isa() noexcept {
+#if defined(JUMP_LIST_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return simd_isa::avx2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return simd_isa::sse42;
+    }
+    return simd_isa::scalar;
+#elif defined(JUMP_LIST_SIMD_NEON)
+    return simd_isa::neon;
+#else
+    return simd_isa::scalar;
+#endif
+}
+
+inline simd_isa cpu_simd_isa() noexcept {
+    static const simd_isa isa = detect_simd_isa();
+    return isa;
+}
+
+// Key types the vector kernels handle: 32- and 64-bit integers and floats.
+template<typename T>
+concept simd_key = (std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 4 || sizeof(T) == 8)) ||
+                   std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+// Fixed-width lane type with the same representation as T.
+template<typename T>
+using simd_lane_t = std::conditional_t<
+    std::is_floating_point_v<T>, T,
+    std::conditional_t<sizeof(T) == 4, std::conditional_t<std::is_signed_v<T>, std::int32_t, std::uint32_t>,
+                       std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>>>;
+
+// +1 for comparators that order keys by <, -1 for those that order them by
+// >, 0 for anything the kernels cannot reproduce.
+template<typename Compare, typename T>
+inline constexpr int simd_order = std::is_same_v<Compare, std::less<T>> || std::is_same_v<Compare, std::less<>> ||
+                                          std::is_same_v<Compare, std::ranges::less>
+                                      ? 1
+                                  : std::is_same_v<Compare, std::greater<T>> ||
+                                          std::is_same_v<Compare, std::greater<>> ||
+                                          std::is_same_v<Compare, std::ranges::greater>
+                                      ? -1
+                                      : 0;
+
+// Each kernel compares all K lanes of keys with probe and returns a bit
+// mask with bit j set when keys[j] > probe (Greater) or keys[j] < probe.
+// Unsigned integers have their sign bit flipped so the signed compare
+// instructions order them correctly.
+
+#if defined(JUMP_LIST_SIMD_X86)
+
+template<typename U, bool Greater, int K>
+[[gnu::target("avx2")]] std::uint64_t compare_mask_avx2(const U* keys, U probe) noexcept {
+    std::uint64_t bits = 0;
+    if constexpr (std::is_same_v<U, float>) {
+        __m256 p = _mm256_set1_ps(probe);
+        for (int j = 0; j < K; j += 8) {
+            __m256 c = _mm256_cmp_ps(_mm256_loadu_ps(keys + j), p, Greater ? _CMP_GT_OQ : _CMP_LT_OQ);
+            bits |= std::uint64_t(static_cast<unsigned>(_mm256_movemask_ps(c))) << j;
+        }
+    } else if constexpr (std::is_same_v<U, double>) {
+        __m256d p = _mm256_set1_pd(probe);
+        for (int j = 0; j < K; j += 4) {
+            __m256d c = _mm256_cmp_pd(_mm256_loadu_pd(keys + j), p, Greater ? _CMP_GT_OQ : _CMP_LT_OQ);
+            bits |= std::uint64_t(static_cast<unsigned>(_mm256_movemask_pd(c))) << j;
+        }
+    } else if constexpr (sizeof(U) == 4) {
+        __m256i bias = _mm256_set1_epi32(std::is_unsigned_v<U> ? INT32_MIN : 0);
+        __m256i p = _mm256_xor_si256(_mm256_set1_epi32(static_cast<std::int32_t>(probe)), bias);
+        for (int j = 0; j < K; j += 8) {
+            __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + j)), bias);
+            __m256i c = Greater ? _mm256_cmpgt_epi32(v, p) : _mm256_cmpgt_epi32(p, v);
+            bits |= std::uint64_t(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(c)))) << j;
+        }
+    } else {
+        __m256i bias = _mm256_set1_epi64x(std::is_unsigned_v<U> ? INT64_MIN : 0);
+        __m256i p = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(probe)), bias);
+        for (int j = 0; j < K; j += 4) {
+            __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + j)), bias);
+            __m256i c = Greater ? _mm256_cmpgt_epi64(v, p) : _mm256_cmpgt_epi64(p, v);
+            bits |= std::uint64_t(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(c)))) << j;
+        }
+    }
+    return bits;
+}
+
+template<typename U, bool Greater, int K>
+[[gnu::target("sse4.2")]] std::uint64_t compare_mask_sse42(const U* keys, U probe) noexcept {
+    std::uint64_t bits = 0;
+    if constexpr (std::is_same_v<U, float>) {
+        __m128 p = _mm_set1_ps(probe);
+        for (int j = 0; j < K; j += 4) {
+            __m128 v = _mm_loadu_ps(keys + j);
+            __m128 c = Greater ? _mm_cmpgt_ps(v, p) : _mm_cmplt_ps(v, p);
+            bits |= std::uint64_t(static_cast<unsigned>(_mm_movemask_ps(c))) << j;
+        }
+    } else if constexpr (std::is_same_v<U, double>) {
+        __m128d p = _mm_set1_pd(probe);
+        for (int j = 0; j < K; j += 2) {
+            __m128d v = _mm_loadu_pd(keys + j);
+            __m128d c = Greater ? _mm_cmpgt_pd(v, p) : _mm_cmplt_pd(v, p);
+            bits |= std::uint64_t(static_cast<unsigned>(_mm_movemask_pd(c))) << j;
+        }
+    } else if constexpr (sizeof(U) == 4) {
+        __m128i bias = _mm_set1_epi32(std::is_unsigned_v<U> ? INT32_MIN : 0);
+        __m128i p = _mm_xor_si128(_mm_set1_epi32(static_cast<std::int32_t>(probe)), bias);
+        for (int j = 0; j < K; j += 4) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + j)), bias);
+            __m128i c = Greater ? _mm_cmpgt_epi32(v, p) : _mm_cmpgt_epi32(p, v);
+            bits |= std::uint64_t(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(c)))) << j;
+        }
+    } else {
+        __m128i bias = _mm_set1_epi64x(std::is_unsigned_v<U> ? INT64_MIN : 0);
+        __m128i p = _mm_xor_si128(_mm_set1_epi64x(static_cast<long long>(probe)), bias);
+        for (int j = 0; j < K; j += 2) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + j)), bias);
+            __m128i c = Greater ? _mm_cmpgt_epi64(v, p) : _mm_cmpgt_epi64(p, v);
+            bits |= std::uint64_t(static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(c)))) << j;
+        }
+    }
+    return bits;
+}
+
+#elif defined(JUMP_LIST_SIMD_NEON)
+
+// NEON has no movemask; each lane's all-ones result is masked with its own
+// bit and the lanes are summed instead.
+template<typename U, bool Greater, int K>
+std::uint64_t compare_mask_neon(const U* keys, U probe) noexcept {
+    std::uint64_t bits = 0;
+    if constexpr (sizeof(U) == 4) {
+        static constexpr std::uint32_t lane_bit[4] = {1, 2, 4, 8};
+        uint32x4_t weight = vld1q_u32(lane_bit);
+        for (int j = 0; j < K; j += 4) {
+            uint32x4_t c;
+            if constexpr (std::is_same_v<U, float>) {
+                float32x4_t v = vld1q_f32(keys + j);
+                float32x4_t p = vdupq_n_f32(probe);
+                c = Greater ? vcgtq_f32(v, p) : vcltq_f32(v, p);
+            } else if constexpr (std::is_signed_v<U>) {
+                int32x4_t v = vld1q_s32(keys + j);
+                int32x4_t p = vdupq_n_s32(probe);
+                c = Greater ? vcgtq_s32(v, p) : vcltq_s32(v, p);
+            } else {
+                uint32x4_t v = vld1q_u32(keys + j);
+                uint32x4_t p = vdupq_n_u32(probe);
+                c = Greater ? vcgtq_u32(v, p) : vcltq_u32(v, p);
+            }
+            bits |= std::uint64_t(vaddvq_u32(vandq_u32(c, weight))) << j;
+        }
+    } else {
+        static constexpr std::uint64_t lane_bit[2] = {1, 2};
+        uint64x2_t weight = vld1q_u64(lane_bit);
+        for (int j = 0; j < K; j += 2) {
+            uint64x2_t c;
+            if constexpr (std::is_same_v<U, double>) {
+                float64x2_t v = vld1q_f64(keys + j);
+                float64x2_t p = vdupq_n_f64(probe);
+                c = Greater ? vcgtq_f64(v, p) : vcltq_f64(v, p);
+            } else if constexpr (std::is_signed_v<U>) {
+                int64x2_t v = vld1q_s64(keys + j);
+                int64x2_t p = vdupq_n_s64(probe);
+                c = Greater ? vcgtq_s64(v, p) : vcltq_s64(v, p);
+            } else {
+                uint64x2_t v = vld1q_u64(keys + j);
+                uint64x2_t p = vdupq_n_u64(probe);
+                c = Greater ? vcgtq_u64(v, p) : vcltq_u64(v, p);
+            }
+            bits |= vaddvq_u64(vandq_u64(c, weight)) << j;
+        }
+    }
+    return bits;
+}
+
+#endif
+
+// Index of the first of the n sorted keys that is not before probe, or with
+// Upper, the first that probe is before. All K slots must be readable; the
+// kernels look at every slot and the ones past n are masked off. Probes of
+// another type than T (heterogeneous lookup) take the scalar search.
+template<bool Upper, int K, typename T, typename P, typename Compare>
+int block_bound(const T* keys, int n, const P& probe, const Compare& comp) noexcept(
+    std::is_nothrow_invocable_v<const Compare&, const T&, const P&> &&
+    std::is_nothrow_invocable_v<const Compare&, const P&, const T&>) {
+    if constexpr (std::is_same_v<P, T> && simd_key<T> && simd_order<Compare, T> != 0) {
+        constexpr bool ascending = simd_order<Compare, T> > 0;
+        // Lower counts the keys before probe, Upper those probe is before.
+        constexpr bool greater = ascending == Upper;
+        using U = simd_lane_t<T>;
+        const U* lanes = reinterpret_cast<const U*>(keys);
+        U p = static_cast<U>(probe);
+        std::uint64_t mask = 0;
+        bool vector = true;
+        switch (cpu_simd_isa()) {
+#if defined(JUMP_LIST_SIMD_X86)
+        case simd_isa::avx2:
+            mask = compare_mask_avx2<U, greater, K>(lanes, p);
+            break;
+        case simd_isa::sse42:
+            mask = compare_mask_sse42<U, greater, K>(lanes, p);
+            break;
+#elif defined(JUMP_LIST_SIMD_NEON)
+        case simd_isa::neon:
+            mask = compare_mask_neon<U, greater, K>(lanes, p);
+            break;
+#endif
+        default:
+            vector = false;
+        }
+        if (vector) {
+            std::uint64_t valid = n == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << n) - 1;
+            int c = std::popcount(mask & valid);
+            return Upper ? n - c : c;
+        }
+    }
+    if constexpr (Upper) {
+        return static_cast<int>(std::upper_bound(keys, keys + n, probe, comp) - keys);
+    } else {
+        return static_cast<int>(std::lower_bound(keys, keys + n, probe, comp) - keys);
+    }
+}
+
+} // namespace jl_detail
+
+// Unrolled jump_list: every bottom-level node holds up to K sorted elements
+// in a small array, and the towers index nodes by their first element. A
+// search follows K times fewer links and finishes with one vector compare
+// inside a node (AVX2 or SSE4.2 picked at runtime, NEON on AArch64) for
+// arithmetic keys ordered by std::less or std::greater; other keys and
+// comparators use a binary search there.
+//
+// Elements are moved within and between nodes with memcpy, so T must be
+// trivially copyable, and inserting or erasing invalidates iterators into
+// the affected node and its neighbour.
+template<typename T, typename Compare, typename Allocator, typename Traits>
+    requires jump_list_comparator<Compare, T> && (Traits::keys_per_node > 1)
+class jump_list<T, Compare, Allocator, Traits> {
+    static_assert(std::is_trivially_copyable_v<T>, "fat nodes need a trivially copyable element type");
+    static_assert(!Traits::indexable, "fat nodes do not support indexable_traits");
+    static_assert(!Traits::compact_links, "fat nodes do not support compact_links");
+    static_assert(Traits::keys_per_node % 8 == 0 && Traits::keys_per_node <= 64,
+                  "keys_per_node must be a multiple of 8 no larger than 64");
+    static_assert(Traits::max_level >= 1 && Traits::max_level <= jl_detail::max_level,
+                  "max_level must lie in [1, jl_detail::max_level]");
+
+    static constexpr int block = static_cast<int>(Traits::keys_per_node);
+
+    struct node {
+        int count;
+        int height;
+        node* prev;
+        alignas(T) unsigned char storage[block * sizeof(T)];
+
+        T* keys() noexcept { return reinterpret_cast<T*>(storage); }
+        const T& first() noexcept { return keys()[0]; }
+        node*& next(int i) noexcept { return reinterpret_cast<node**>(this + 1)[i]; }
+    };
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using unit = jl_detail::storage_unit<std::max(alignof(node), alignof(void*))>;
+    using unit_allocator = typename alloc_traits::template rebind_alloc<unit>;
+    using level_policy = typename Traits::level_policy;
+
+    static constexpr int max_level = Traits::max_level;
+
+    using pool_type = jl_detail::node_pool<unit_allocator, max_level>;
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = typename alloc_traits::pointer;
+    using const_pointer = typename alloc_traits::const_pointer;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() noexcept = default;
+
+        reference operator*() const noexcept { return node_->keys()[index_]; }
+        pointer operator->() const noexcept { return node_->keys() + index_; }
+
+        const_iterator& operator++() noexcept {
+            if (++index_ == node_->count) {
+                node_ = node_->next(0);
+                index_ = 0;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        const_iterator& operator--() noexcept {
+            if (index_ == 0) {
+                node_ = node_->prev;
+                index_ = node_->count;
+            }
+            --index_;
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept {
+            const_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        friend bool operator==(const const_iterator&, const const_iterator&) = default;
+
+    private:
+        friend class jump_list;
+
+        const_iterator(node* n, int index) noexcept : node_(n), index_(index) {}
+
+        node* node_ = nullptr;
+        int index_ = 0;
+    };
+
+    using iterator = const_iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // Construction and destruction
+
+    jump_list() : jump_list(Compare()) {}
+
+    explicit jump_list(const Compare& comp, const Allocator& alloc = Allocator())
+        : comp_(comp), pool_(unit_allocator(alloc), &bucket_size) {
+        reset_head();
+    }
+
+    explicit jump_list(const Allocator& alloc) : jump_list(Compare(), alloc) {}
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    jump_list(It first, It last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : jump_list(comp, alloc) {
+        insert(first, last);
+    }
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    jump_list(It first, It last, const Allocator& alloc) : jump_list(first, last, Compare(), alloc) {}
+
+    // Packs [first, last), which must be sorted by comp, into full nodes in
+    // one linear pass.
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    jump_list(sorted_equivalent_t, It first, It last, const Compare& comp = Compare(),
+              const Allocator& alloc = Allocator())
+        : jump_list(comp, alloc) {
+        append_sorted(first, last);
+    }
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    jump_list(sorted_equivalent_t, It first, It last, const Allocator& alloc)
+        : jump_list(sorted_equivalent, first, last, Compare(), alloc) {}
+
+    jump_list(std::initializer_list<T> init, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : jump_list(comp, alloc) {
+        insert(init);
+    }
+
+    jump_list(std::initializer_list<T> init, const Allocator& alloc) : jump_list(init, Compare(), alloc) {}
+
+    jump_list(const jump_list& other)
+        : jump_list(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+    jump_list(const jump_list& other, const Allocator& alloc) : jump_list(other.comp_, alloc) {
+        append_sorted(other.begin(), other.end());
+    }
+
+    jump_list(jump_list&& other) noexcept : comp_(other.comp_), pool_(std::move(other.pool_)), levels_(other.levels_) {
+        reset_head();
+        adopt_links(other);
+    }
+
+    jump_list(jump_list&& other, const Allocator& alloc) : jump_list(other.comp_, alloc) {
+        if (get_allocator() == other.get_allocator()) {
+            pool_.template take<false>(other.pool_);
+            adopt_links(other);
+        } else {
+            append_sorted(other.begin(), other.end());
+            other.clear();
+        }
+    }
+
+    ~jump_list() = default;
+
+    jump_list& operator=(const jump_list& other) {
+        if (this != &other) {
+            constexpr bool propagate = alloc_traits::propagate_on_container_copy_assignment::value;
+            jump_list tmp(other, propagate ? other.get_allocator() : get_allocator());
+            swap_storage<true>(tmp);
+        }
+        return *this;
+    }
+
+    jump_list& operator=(jump_list&& other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+        constexpr bool propagate = alloc_traits::propagate_on_container_move_assignment::value;
+        clear();
+        comp_ = other.comp_;
+        if (propagate || get_allocator() == other.get_allocator()) {
+            pool_.template take<propagate>(other.pool_);
+            adopt_links(other);
+        } else {
+            append_sorted(other.begin(), other.end());
+            other.clear();
+        }
+        return *this;
+    }
+
+    jump_list& operator=(std::initializer_list<T> init) {
+        jump_list tmp(init, comp_, get_allocator());
+        swap_storage<true>(tmp);
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return allocator_type(pool_.allocator()); }
+
+    // Iterators
+
+    iterator begin() const noexcept { return iterator(head()->next(0), 0); }
+    iterator end() const noexcept { return iterator(head(), 0); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    reverse_iterator rbegin() const noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() const noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    size_type size() const noexcept { return size_; }
+    size_type max_size() const noexcept {
+        return static_cast<size_type>(std::numeric_limits<difference_type>::max()) / sizeof(T);
+    }
+
+    // Modifiers
+
+    void clear() noexcept {
+        pool_.release();
+        reset_head();
+    }
+
+    // The element goes after its equivalents. A full node is split in half,
+    // except when the element lands past its end, where it starts a fresh
+    // node so ascending insertions leave the nodes full.
+    iterator insert(const T& value) {
+        T v = value;
+        node* update[max_level];
+        node* b = descend([&](node* x) { return !comp_(v, x->first()); }, update);
+        int pos = 0;
+        if (b != head()) {
+            pos = jl_detail::block_bound<true, block>(b->keys(), b->count, v, comp_);
+        } else if (head()->next(0) != head()) {
+            // Smaller than everything: goes to the front of the first node.
+            b = head()->next(0);
+        }
+        if (b == head() || b->count == block) {
+            std::fill(update, update + std::min(b->height, level), b);
+            node* n = create_node(random_level());
+            link_after(n, update);
+            if (b != head() && pos < block) {
+                constexpr int half = block / 2;
+                std::memcpy(n->keys(), b->keys() + half, (block - half) * sizeof(T));
+                n->count = block - half;
+                b->count = half;
+                if (pos > half) {
+                    pos -= half;
+                    b = n;
+                }
+            } else {
+                b = n;
+                pos = 0;
+            }
+        }
+        T* keys = b->keys();
+        std::memmove(keys + pos + 1, keys + pos, (b->count - pos) * sizeof(T));
+        std::construct_at(keys + pos, v);
+        ++b->count;
+        ++size_;
+        return iterator(b, pos);
+    }
+
+    // Elements are stored by value in node arrays, so these build the element
+    // first and insert it; there is no per-element node to hand out, hence
+    // no extract(). The hint is not used.
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    iterator emplace(Args&&... args) {
+        return insert(T(std::forward<Args>(args)...));
+    }
+
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    iterator emplace_hint(const_iterator, Args&&... args) {
+        return insert(T(std::forward<Args>(args)...));
+    }
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    void insert(It first, It last) {
+        if constexpr (std::forward_iterator<It> && std::same_as<std::iter_value_t<It>, T>) {
+            if (size_ == 0 && std::is_sorted(first, last, comp_)) {
+                append_sorted(first, last);
+                return;
+            }
+        }
+        for (; first != last; ++first) {
+            insert(T(*first));
+        }
+    }
+
+    void insert(std::initializer_list<T> init) { insert(init.begin(), init.end()); }
+
+    // A node whose neighbour has become sparse absorbs it, so mass erasure
+    // does not leave a trail of near-empty nodes behind.
+    iterator erase(const_iterator pos) {
+        node* b = pos.node_;
+        int i = pos.index_;
+        --size_;
+        if (b->count == 1) {
+            node* next = b->next(0);
+            unlink(b);
+            destroy_node(b);
+            return iterator(next, 0);
+        }
+        T* keys = b->keys();
+        std::memmove(keys + i, keys + i + 1, (b->count - i - 1) * sizeof(T));
+        --b->count;
+        node* next = b->next(0);
+        if (next != head() && b->count + next->count <= block / 2) {
+            std::memcpy(keys + b->count, next->keys(), next->count * sizeof(T));
+            unlink(next);
+            b->count += next->count;
+            destroy_node(next);
+        }
+        return i < b->count ? iterator(b, i) : iterator(b->next(0), 0);
+    }
+
+    // Iterators into the range are invalidated as it is erased, so the run
+    // is counted first and erased from its front.
+    iterator erase(const_iterator first, const_iterator last) {
+        for (auto n = std::distance(first, last); n > 0; --n) {
+            first = erase(first);
+        }
+        return first;
+    }
+
+    size_type erase(const T& key) {
+        auto [first, last] = equal_range(key);
+        auto n = static_cast<size_type>(std::distance(first, last));
+        erase(first, last);
+        return n;
+    }
+
+    void swap(jump_list& other) noexcept(std::is_nothrow_swappable_v<Compare>) {
+        swap_storage<alloc_traits::propagate_on_container_swap::value>(other);
+    }
+
+    friend void swap(jump_list& a, jump_list& b) noexcept(noexcept(a.swap(b))) { a.swap(b); }
+
+    // Lookup
+
+    size_type count(const T& key) const {
+        auto [first, last] = equal_range(key);
+        return static_cast<size_type>(std::distance(first, last));
+    }
+
+    iterator find(const T& key) const { return find_at(key); }
+
+    bool contains(const T& key) const { return find(key) != end(); }
+
+    iterator lower_bound(const T& key) const { return bound_at<false>(key); }
+    iterator upper_bound(const T& key) const { return bound_at<true>(key); }
+
+    std::pair<iterator, iterator> equal_range(const T& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // Heterogeneous lookup for transparent comparators, as in the plain
+    // layout.
+
+    template<jump_list_lookup_key<Compare, T> K>
+    size_type count(const K& key) const {
+        auto [first, last] = equal_range(key);
+        return static_cast<size_type>(std::distance(first, last));
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator find(const K& key) const {
+        return find_at(key);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    bool contains(const K& key) const {
+        return find(key) != end();
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator lower_bound(const K& key) const {
+        return bound_at<false>(key);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator upper_bound(const K& key) const {
+        return bound_at<true>(key);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    std::pair<iterator, iterator> equal_range(const K& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // Range scans
+
+    // Calls f with a std::span<const T> over each node's share of the whole
+    // list, or of [lower_bound(lo), lower_bound(hi)), in order, so the
+    // callback runs over contiguous arrays. Every node is prefetched in
+    // full while f works on the one before it.
+    template<typename F>
+        requires std::invocable<F&, std::span<const T>>
+    void visit_blocks(F f) const {
+        visit_from(begin(), [](node* b) { return b->count; }, f);
+    }
+
+    template<typename F>
+        requires std::invocable<F&, std::span<const T>>
+    void visit_blocks(const T& lo, const T& hi, F f) const {
+        visit_between(lo, hi, f);
+    }
+
+    // Calls f on every element in [lo, hi), in order, one node at a time.
+    template<typename F>
+        requires std::invocable<F&, const T&>
+    void for_each_range(const T& lo, const T& hi, F f) const {
+        visit_between(lo, hi, [&](std::span<const T> span) {
+            for (const T& v : span) {
+                std::invoke(f, v);
+            }
+        });
+    }
+
+    template<jump_list_lookup_key<Compare, T> K, typename F>
+        requires std::invocable<F&, std::span<const T>>
+    void visit_blocks(const K& lo, const K& hi, F f) const {
+        visit_between(lo, hi, f);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K, typename F>
+        requires std::invocable<F&, const T&>
+    void for_each_range(const K& lo, const K& hi, F f) const {
+        visit_between(lo, hi, [&](std::span<const T> span) {
+            for (const T& v : span) {
+                std::invoke(f, v);
+            }
+        });
+    }
+
+    // Parallel iteration
+
+    // Cuts the list into at most n non-empty, contiguous subranges at node
+    // boundaries, picked as in the plain layout from the highest level with
+    // at least n log2(size) nodes. A list of fewer than n nodes gives one
+    // part per node.
+    std::vector<std::ranges::subrange<const_iterator>> partition(size_type n) const {
+        std::vector<std::ranges::subrange<const_iterator>> parts;
+        if (n == 0 || size_ == 0) {
+            return parts;
+        }
+        std::vector<node*> row;
+        auto wanted = n * static_cast<size_type>(std::bit_width(size_));
+        for (int i = level - 1; i >= 0 && row.size() < wanted; --i) {
+            row.clear();
+            for (node* x = head()->next(i); x != head(); x = x->next(i)) {
+                row.push_back(x);
+            }
+        }
+        n = std::min(n, row.size());
+        node* from = head()->next(0);
+        for (size_type j = 1; j <= n; ++j) {
+            node* to = j == n ? head() : row[row.size() * j / n];
+            parts.emplace_back(iterator(from, 0), iterator(to, 0));
+            from = to;
+        }
+        return parts;
+    }
+
+    // Serialization
+
+    // Writes the same snapshot format as the other layouts; see the plain
+    // layout's save(). Throws std::runtime_error if the stream fails.
+    void save(std::ostream& os) const
+        requires std::is_trivially_copyable_v<T>
+    {
+        jl_detail::save_snapshot(os, *this);
+    }
+
+    // Reads a snapshot written by any layout's save(), as the plain
+    // layout's load() does, building the nodes chunk by chunk.
+    void load(std::istream& is)
+        requires std::is_trivially_copyable_v<T>
+    {
+        jl_detail::load_snapshot(
+            is, *this, [this](auto first, auto last) { append_sorted(first, last); },
+            [this]() -> const T& { return *std::prev(end()); });
+    }
+
+    // Observers
+
+    key_compare key_comp() const { return comp_; }
+    value_compare value_comp() const { return comp_; }
+
+    // Comparison
+
+    // Integral, enumeration and pointer elements, whose values are equal
+    // exactly when their bytes are, are compared node against node with
+    // memcmp (vectorized by the C library) up to the first difference;
+    // other types element by element. Lists of different sizes are never
+    // equal.
+    friend bool operator==(const jump_list& a, const jump_list& b) {
+        if (a.size_ != b.size_) {
+            return false;
+        }
+        if constexpr (bytewise_equal) {
+            return mismatch(a, b).first == a.end();
+        } else {
+            return std::equal(a.begin(), a.end(), b.begin());
+        }
+    }
+
+    friend auto operator<=>(const jump_list& a, const jump_list& b) {
+        if constexpr (bytewise_equal) {
+            using ordering = decltype(jl_detail::synth_three_way{}(std::declval<const T&>(), std::declval<const T&>()));
+            auto [x, y] = mismatch(a, b);
+            if (x == a.end() || y == b.end()) {
+                return ordering(a.size_ <=> b.size_);
+            }
+            return jl_detail::synth_three_way{}(*x, *y);
+        } else {
+            return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end(),
+                                                          jl_detail::synth_three_way{});
+        }
+    }
+
+private:
+    static constexpr bool bytewise_equal = std::is_scalar_v<T> && std::has_unique_object_representations_v<T>;
+
+    static std::size_t node_size(int height) noexcept { return sizeof(node) + height * sizeof(node*); }
+
+    // std::mismatch over a and b, comparing the overlapping stretches of
+    // their current nodes as one memcmp each.
+    static std::pair<const_iterator, const_iterator> mismatch(const jump_list& a, const jump_list& b) noexcept
+        requires bytewise_equal
+    {
+        node* x = a.head()->next(0);
+        node* y = b.head()->next(0);
+        int i = 0;
+        int j = 0;
+        while (x != a.head() && y != b.head()) {
+            jl_detail::prefetch(x->next(0));
+            jl_detail::prefetch(y->next(0));
+            int n = std::min(x->count - i, y->count - j);
+            const T* p = x->keys() + i;
+            const T* q = y->keys() + j;
+            if (std::memcmp(p, q, n * sizeof(T)) != 0) {
+                int k = 0;
+                while (p[k] == q[k]) {
+                    ++k;
+                }
+                return {const_iterator(x, i + k), const_iterator(y, j + k)};
+            }
+            if ((i += n) == x->count) {
+                x = x->next(0);
+                i = 0;
+            }
+            if ((j += n) == y->count) {
+                y = y->next(0);
+                j = 0;
+            }
+        }
+        return {const_iterator(x, i), const_iterator(y, j)};
+    }
+
+    static std::size_t bucket_size(std::size_t bucket) noexcept { return node_size(static_cast<int>(bucket) + 1); }
+
+    node* head() const noexcept {
+        return std::launder(reinterpret_cast<node*>(const_cast<unsigned char*>(head_storage_)));
+    }
+
+    void reset_head() noexcept {
+        node* h = ::new (static_cast<void*>(head_storage_)) node;
+        h->count = 0;
+        h->height = max_level;
+        h->prev = h;
+        for (int i = 0; i < max_level; ++i) {
+            h->next(i) = h;
+        }
+        level = 1;
+        size_ = 0;
+    }
+
+    // Capped by the node count, as in the plain layout.
+    int random_level() { return levels_(std::min(static_cast<int>(std::bit_width(size_ / block)) + 1, max_level)); }
+
+    // Position i of node b, or the start of the next node when i is past
+    // b's last element. The head stands for "before the first node".
+    iterator at(node* b, int i) const noexcept {
+        if (b == head() || i == b->count) {
+            return iterator(b->next(0), 0);
+        }
+        return iterator(b, i);
+    }
+
+    // Fills update[0, level) with the last node on each level whose first
+    // element satisfies before and returns the one on level 0.
+    template<typename Before>
+    node* descend(Before before, node** update) const {
+        node* x = head();
+        for (int i = level - 1; i >= 0; --i) {
+            while (x->next(i) != head() && before(x->next(i))) {
+                x = x->next(i);
+            }
+            update[i] = x;
+        }
+        return x;
+    }
+
+    // lower_bound with Upper false, upper_bound with it set. K is T or a
+    // transparent lookup key.
+    template<bool Upper, typename K>
+    iterator bound_at(const K& key) const {
+        node* update[max_level];
+        node* b;
+        if constexpr (Upper) {
+            b = descend([&](node* x) { return !comp_(key, x->first()); }, update);
+        } else {
+            b = descend([&](node* x) { return comp_(x->first(), key); }, update);
+        }
+        int i = b == head() ? 0 : jl_detail::block_bound<Upper, block>(b->keys(), b->count, key, comp_);
+        return at(b, i);
+    }
+
+    template<typename K>
+    iterator find_at(const K& key) const {
+        iterator it = bound_at<false>(key);
+        return it != end() && !comp_(key, *it) ? it : end();
+    }
+
+    // Hands f the elements of each node from first on, up to the index
+    // stop(b) returns for node b; a stop short of b->count ends the visit.
+    template<typename Stop, typename F>
+    void visit_from(const_iterator first, Stop stop, F&& f) const {
+        node* b = first.node_;
+        for (int i = first.index_; b != head(); i = 0) {
+            node* next = b->next(0);
+            for (std::size_t offset = 0; offset < sizeof(node); offset += 64) {
+                jl_detail::prefetch(reinterpret_cast<const unsigned char*>(next) + offset);
+            }
+            int j = stop(b);
+            if (i < j) {
+                std::invoke(f, std::span<const T>(b->keys() + i, static_cast<std::size_t>(j - i)));
+            }
+            if (j < b->count) {
+                return;
+            }
+            b = next;
+        }
+    }
+
+    template<typename K, typename F>
+    void visit_between(const K& lo, const K& hi, F&& f) const {
+        visit_from(
+            bound_at<false>(lo),
+            [&](node* b) {
+                if (comp_(b->keys()[b->count - 1], hi)) {
+                    return b->count;
+                }
+                return jl_detail::block_bound<false, block>(b->keys(), b->count, hi, comp_);
+            },
+            f);
+    }
+
+    // Nodes are zero-filled so the vector compares never read indeterminate
+    // slots past count.
+    node* create_node(int height) {
+        node* n = ::new (pool_.allocate(static_cast<std::size_t>(height) - 1)) node;
+        n->count = 0;
+        n->height = height;
+        std::memset(n->storage, 0, sizeof(n->storage));
+        return n;
+    }
+
+    void destroy_node(node* n) noexcept {
+        std::size_t bucket = static_cast<std::size_t>(n->height) - 1;
+        n->~node();
+        pool_.deallocate(bucket, n);
+    }
+
+    // Links n right after update[i] on each of its levels and advances
+    // update to n.
+    void link_after(node* n, node** update) noexcept {
+        if (n->height > level) {
+            std::fill(update + level, update + n->height, head());
+            level = n->height;
+        }
+        n->prev = update[0];
+        for (int i = 0; i < n->height; ++i) {
+            n->next(i) = update[i]->next(i);
+            update[i]->next(i) = n;
+            update[i] = n;
+        }
+        n->next(0)->prev = n;
+    }
+
+    // Unlinks n, which must still hold its first element, from every level.
+    void unlink(node* n) noexcept {
+        node* x = head();
+        for (int i = level - 1; i >= 0; --i) {
+            while (x->next(i) != head() && comp_(x->next(i)->first(), n->first())) {
+                x = x->next(i);
+            }
+            if (i < n->height) {
+                while (x->next(i) != n) {
+                    x = x->next(i);
+                }
+                x->next(i) = n->next(i);
+            }
+        }
+        n->next(0)->prev = n->prev;
+        while (level > 1 && head()->next(level - 1) == head()) {
+            --level;
+        }
+    }
+
+    // Height of the k-th node (k >= 1) of a bulk build, as in the plain
+    // layout.
+    static int balanced_height(size_type k) noexcept {
+        return std::min(std::countr_zero(k) + 1, max_level);
+    }
+
+    // Appends a range not less than the current last element, filling fresh
+    // nodes to capacity. Heights go on from the node count the current size
+    // would take if every node were full.
+    template<typename It, typename Sent>
+    void append_sorted(It first, Sent last) {
+        node* update[max_level];
+        node* x = head();
+        for (int i = max_level - 1; i >= 0; --i) {
+            while (i < level && x->next(i) != head()) {
+                x = x->next(i);
+            }
+            update[i] = x;
+        }
+        node* b = nullptr;
+        for (size_type k = size_ / block + 1; first != last; ++first) {
+            T v(*first);
+            if (!b || b->count == block) {
+                b = create_node(balanced_height(k++));
+                link_after(b, update);
+            }
+            std::construct_at(b->keys() + b->count++, v);
+            ++size_;
+        }
+    }
+
+    void adopt_links(jump_list& other) noexcept {
+        if (other.size_ == 0) {
+            other.reset_head();
+            return;
+        }
+        node* old_head = other.head();
+        level = other.level;
+        size_ = other.size_;
+        for (int i = 0; i < level; ++i) {
+            head()->next(i) = old_head->next(i);
+        }
+        head()->prev = old_head->prev;
+        head()->next(0)->prev = head();
+        node* x = head();
+        for (int i = level - 1; i >= 0; --i) {
+            while (x->next(i) != old_head) {
+                x = x->next(i);
+            }
+            x->next(i) = head();
+        }
+        other.reset_head();
+    }
+
+    template<bool PropagateAlloc>
+    void swap_storage(jump_list& other) noexcept(std::is_nothrow_swappable_v<Compare>) {
+        using std::swap;
+        swap(comp_, other.comp_);
+        swap(levels_, other.levels_);
+        jump_list parked(std::move(*this));
+        pool_.template take<PropagateAlloc>(other.pool_);
+        adopt_links(other);
+        other.pool_.template take<PropagateAlloc>(parked.pool_);
+        other.adopt_links(parked);
+    }
+
+    [[no_unique_address]] Compare comp_;
+    pool_type pool_;
+    alignas(node) unsigned char head_storage_[sizeof(node) + max_level * sizeof(node*)];
+    int level;
+    size_t size_;
+    [[no_unique_address]] level_policy levels_;
+};
+
+#endif // JUMP_LIST_FAT_H
@@ -0,0 +1,613 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+#ifndef JUMP_LIST_MAP_H
+#define JUMP_LIST_MAP_H
+
+#include "jump_list.h"
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Ordered map with unique keys built on a skip list. A node holds only the
+// key, its bookkeeping and its tower; the mapped value lives out of line in
+// a separate slab pool and the node points at it. Searches and walks along
+// level 0 therefore pull in key-bearing cache lines only, however large V
+// is. Mapped values keep their address for as long as their element
+// exists, and values inserted in key order (as by copying or by ascending
+// insertion) sit next to each other in the pool, so a pass over them is a
+// sequential scan.
+//
+// Dereferencing an iterator gives a std::pair<const K&, V&> built on the
+// fly; key() and value() reach either side directly.
+template<typename K, typename V, typename Compare = std::less<K>,
+         typename Allocator = std::allocator<std::pair<const K, V>>, typename Traits = jump_list_traits>
+    requires jump_list_comparator<Compare, K>
+class jump_list_map {
+    static_assert(Traits::keys_per_node == 1 && !Traits::indexable && !Traits::compact_links,
+                  "jump_list_map supports the plain layout only");
+    static_assert(Traits::max_level >= 1 && Traits::max_level <= jl_detail::max_level,
+                  "max_level must lie in [1, jl_detail::max_level]");
+
+    struct node {
+        union {
+            K key;
+        };
+        int height;
+        node* prev;
+        V* mapped;
+
+        node() noexcept {}
+        ~node() {}
+
+        node*& next(int i) noexcept { return reinterpret_cast<node**>(this + 1)[i]; }
+    };
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using key_allocator = typename alloc_traits::template rebind_alloc<K>;
+    using mapped_allocator = typename alloc_traits::template rebind_alloc<V>;
+    using unit = jl_detail::storage_unit<std::max(alignof(node), alignof(void*))>;
+    using unit_allocator = typename alloc_traits::template rebind_alloc<unit>;
+    using mapped_unit = jl_detail::storage_unit<std::max(alignof(V), alignof(void*))>;
+    using mapped_unit_allocator = typename alloc_traits::template rebind_alloc<mapped_unit>;
+    using level_policy = typename Traits::level_policy;
+
+    static constexpr int max_level = Traits::max_level;
+
+    using pool_type = jl_detail::node_pool<unit_allocator, max_level>;
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+
+    template<bool Const>
+    class basic_iterator {
+        using mapped_ref = std::conditional_t<Const, const V&, V&>;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::pair<K, V>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const K&, mapped_ref>;
+
+        // Lets it->first and it->second work on the pair of references.
+        class pointer {
+        public:
+            const reference* operator->() const noexcept { return std::addressof(ref_); }
+
+        private:
+            friend class basic_iterator;
+
+            explicit pointer(reference ref) noexcept : ref_(ref) {}
+
+            reference ref_;
+        };
+
+        basic_iterator() noexcept = default;
+
+        template<bool OtherConst>
+            requires(Const && !OtherConst)
+        basic_iterator(const basic_iterator<OtherConst>& other) noexcept : node_(other.node_) {}
+
+        reference operator*() const noexcept { return {node_->key, *node_->mapped}; }
+        pointer operator->() const noexcept { return pointer(**this); }
+
+        const K& key() const noexcept { return node_->key; }
+        mapped_ref value() const noexcept { return *node_->mapped; }
+
+        basic_iterator& operator++() noexcept {
+            node_ = node_->next(0);
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept {
+            basic_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        basic_iterator& operator--() noexcept {
+            node_ = node_->prev;
+            return *this;
+        }
+
+        basic_iterator operator--(int) noexcept {
+            basic_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        friend bool operator==(const basic_iterator&, const basic_iterator&) = default;
+
+    private:
+        friend class jump_list_map;
+        friend class basic_iterator<!Const>;
+
+        explicit basic_iterator(node* n) noexcept : node_(n) {}
+
+        node* node_ = nullptr;
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // Construction and destruction
+
+    jump_list_map() : jump_list_map(Compare()) {}
+
+    explicit jump_list_map(const Compare& comp, const Allocator& alloc = Allocator())
+        : comp_(comp), pool_(unit_allocator(alloc), &bucket_size), mapped_alloc_(alloc) {
+        mapped_pool_.set_block_size(sizeof(V));
+        reset_head();
+    }
+
+    explicit jump_list_map(const Allocator& alloc) : jump_list_map(Compare(), alloc) {}
+
+    template<std::input_iterator It>
+    jump_list_map(It first, It last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : jump_list_map(comp, alloc) {
+        insert(first, last);
+    }
+
+    jump_list_map(std::initializer_list<value_type> init, const Compare& comp = Compare(),
+                  const Allocator& alloc = Allocator())
+        : jump_list_map(comp, alloc) {
+        insert(init.begin(), init.end());
+    }
+
+    jump_list_map(const jump_list_map& other)
+        : jump_list_map(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+    // The copy is built in key order in one pass, so its mapped values are
+    // laid out in key order too.
+    jump_list_map(const jump_list_map& other, const Allocator& alloc) : jump_list_map(other.comp_, alloc) {
+        node* update[max_level];
+        std::fill(std::begin(update), std::end(update), head());
+        for (node* n = other.head()->next(0); n != other.head(); n = n->next(0)) {
+            link_after(create_node(balanced_height(size_ + 1), n->key, *n->mapped), update);
+        }
+    }
+
+    jump_list_map(jump_list_map&& other) noexcept
+        : comp_(other.comp_), pool_(std::move(other.pool_)), mapped_alloc_(other.mapped_alloc_),
+          mapped_pool_(std::move(other.mapped_pool_)), levels_(other.levels_) {
+        reset_head();
+        adopt_links(other);
+    }
+
+    ~jump_list_map() {
+        destroy_values();
+        mapped_pool_.release(mapped_alloc_);
+    }
+
+    jump_list_map& operator=(const jump_list_map& other) {
+        if (this != &other) {
+            constexpr bool propagate = alloc_traits::propagate_on_container_copy_assignment::value;
+            jump_list_map tmp(other, propagate ? other.get_allocator() : get_allocator());
+            take<true>(tmp);
+        }
+        return *this;
+    }
+
+    jump_list_map& operator=(jump_list_map&& other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+        constexpr bool propagate = alloc_traits::propagate_on_container_move_assignment::value;
+        if (propagate || get_allocator() == other.get_allocator()) {
+            take<propagate>(other);
+        } else {
+            clear();
+            comp_ = other.comp_;
+            for (node* n = other.head()->next(0); n != other.head(); n = n->next(0)) {
+                try_emplace(std::move(n->key), std::move(*n->mapped));
+            }
+            other.clear();
+        }
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return allocator_type(pool_.allocator()); }
+
+    // Iterators
+
+    iterator begin() noexcept { return iterator(head()->next(0)); }
+    iterator end() noexcept { return iterator(head()); }
+    const_iterator begin() const noexcept { return const_iterator(head()->next(0)); }
+    const_iterator end() const noexcept { return const_iterator(head()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    size_type size() const noexcept { return size_; }
+    size_type max_size() const noexcept {
+        return static_cast<size_type>(std::numeric_limits<difference_type>::max()) / (sizeof(node) + sizeof(V));
+    }
+
+    // Element access
+
+    // The value mapped to key, default-constructed first if key is absent.
+    V& operator[](const K& key)
+        requires std::default_initializable<V>
+    {
+        return try_emplace(key).first.value();
+    }
+
+    V& operator[](K&& key)
+        requires std::default_initializable<V>
+    {
+        return try_emplace(std::move(key)).first.value();
+    }
+
+    // Throws std::out_of_range if key is absent.
+    V& at(const K& key) { return *checked_node(key)->mapped; }
+    const V& at(const K& key) const { return *checked_node(key)->mapped; }
+
+    // Modifiers
+
+    // Destroys all elements and hands every slab of both pools back to the
+    // allocator.
+    void clear() noexcept {
+        destroy_values();
+        pool_.release();
+        mapped_pool_.release(mapped_alloc_);
+        reset_head();
+    }
+
+    // Constructs the mapped value from args only if key is absent; otherwise
+    // nothing is moved from key or args.
+    template<typename... Args>
+        requires std::constructible_from<V, Args...>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        return emplace_unique(key, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+        requires std::constructible_from<V, Args...>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        return emplace_unique(std::move(key), std::forward<Args>(args)...);
+    }
+
+    // Inserts key with obj, or assigns obj to the value already mapped to
+    // key. The second member tells whether an element was inserted.
+    template<typename M>
+        requires std::constructible_from<V, M&&> && std::assignable_from<V&, M&&>
+    std::pair<iterator, bool> insert_or_assign(const K& key, M&& obj) {
+        return assign_unique(key, std::forward<M>(obj));
+    }
+
+    template<typename M>
+        requires std::constructible_from<V, M&&> && std::assignable_from<V&, M&&>
+    std::pair<iterator, bool> insert_or_assign(K&& key, M&& obj) {
+        return assign_unique(std::move(key), std::forward<M>(obj));
+    }
+
+    // Inserts a (key, value) pair unless the key is present.
+    std::pair<iterator, bool> insert(const value_type& kv) { return try_emplace(kv.first, kv.second); }
+
+    template<typename P>
+        requires std::constructible_from<K, decltype(std::get<0>(std::declval<P>()))> &&
+                 std::constructible_from<V, decltype(std::get<1>(std::declval<P>()))>
+    std::pair<iterator, bool> insert(P&& kv) {
+        return emplace_unique(std::get<0>(std::forward<P>(kv)), std::get<1>(std::forward<P>(kv)));
+    }
+
+    template<std::input_iterator It>
+    void insert(It first, It last) {
+        for (; first != last; ++first) {
+            insert(*first);
+        }
+    }
+
+    void insert(std::initializer_list<value_type> init) { insert(init.begin(), init.end()); }
+
+    iterator erase(const_iterator pos) {
+        node* n = pos.node_;
+        node* next = n->next(0);
+        unlink(n);
+        destroy_node(n);
+        return iterator(next);
+    }
+
+    iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+    size_type erase(const K& key) {
+        node* n = find_node(key);
+        if (n == head()) {
+            return 0;
+        }
+        erase(const_iterator(n));
+        return 1;
+    }
+
+    void swap(jump_list_map& other) noexcept(std::is_nothrow_swappable_v<Compare>) {
+        jump_list_map tmp(std::move(other));
+        other.template take<alloc_traits::propagate_on_container_swap::value>(*this);
+        take<alloc_traits::propagate_on_container_swap::value>(tmp);
+    }
+
+    friend void swap(jump_list_map& a, jump_list_map& b) noexcept(noexcept(a.swap(b))) { a.swap(b); }
+
+    // Lookup
+
+    size_type count(const K& key) const { return contains(key) ? 1 : 0; }
+
+    iterator find(const K& key) { return iterator(find_node(key)); }
+    const_iterator find(const K& key) const { return const_iterator(find_node(key)); }
+
+    bool contains(const K& key) const { return find_node(key) != head(); }
+
+    iterator lower_bound(const K& key) { return iterator(lower_bound_node(key)); }
+    const_iterator lower_bound(const K& key) const { return const_iterator(lower_bound_node(key)); }
+
+    iterator upper_bound(const K& key) { return iterator(upper_bound_node(key)); }
+    const_iterator upper_bound(const K& key) const { return const_iterator(upper_bound_node(key)); }
+
+    std::pair<iterator, iterator> equal_range(const K& key) { return {lower_bound(key), upper_bound(key)}; }
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // Observers
+
+    key_compare key_comp() const { return comp_; }
+
+    // Comparison
+
+    friend bool operator==(const jump_list_map& a, const jump_list_map& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const auto& x, const auto& y) {
+            return x.first == y.first && x.second == y.second;
+        });
+    }
+
+private:
+    static std::size_t node_size(int height) noexcept { return sizeof(node) + height * sizeof(node*); }
+
+    static std::size_t bucket_size(std::size_t bucket) noexcept { return node_size(static_cast<int>(bucket) + 1); }
+
+    node* head() const noexcept {
+        return std::launder(reinterpret_cast<node*>(const_cast<unsigned char*>(head_storage_)));
+    }
+
+    void reset_head() noexcept {
+        node* h = ::new (static_cast<void*>(head_storage_)) node;
+        h->height = max_level;
+        h->prev = h;
+        h->mapped = nullptr;
+        for (int i = 0; i < max_level; ++i) {
+            h->next(i) = h;
+        }
+        level = 1;
+        size_ = 0;
+    }
+
+    int random_level() { return levels_(std::min(static_cast<int>(std::bit_width(size_)) + 1, max_level)); }
+
+    static int balanced_height(size_type k) noexcept { return std::min(std::countr_zero(k) + 1, max_level); }
+
+    // Fills update[0, level) with the last node on each level whose key is
+    // less than key and returns the node after it on level 0. Only keys are
+    // read on the way down.
+    node* descend(const K& key, node** update) const {
+        node* x = head();
+        for (int i = level - 1; i >= 0; --i) {
+            while (x->next(i) != head() && comp_(x->next(i)->key, key)) {
+                x = x->next(i);
+            }
+            update[i] = x;
+        }
+        return x->next(0);
+    }
+
+    node* lower_bound_node(const K& key) const {
+        node* update[max_level];
+        return descend(key, update);
+    }
+
+    node* upper_bound_node(const K& key) const {
+        node* n = lower_bound_node(key);
+        return n != head() && !comp_(key, n->key) ? n->next(0) : n;
+    }
+
+    node* find_node(const K& key) const {
+        node* n = lower_bound_node(key);
+        return n != head() && !comp_(key, n->key) ? n : head();
+    }
+
+    node* checked_node(const K& key) const {
+        node* n = find_node(key);
+        if (n == head()) {
+            throw std::out_of_range("jump_list_map::at: key not found");
+        }
+        return n;
+    }
+
+    template<typename KK, typename... Args>
+    std::pair<iterator, bool> emplace_unique(KK&& key, Args&&... args) {
+        node* update[max_level];
+        node* n = descend(key, update);
+        if (n != head() && !comp_(key, n->key)) {
+            return {iterator(n), false};
+        }
+        n = create_node(random_level(), std::forward<KK>(key), std::forward<Args>(args)...);
+        link_after(n, update);
+        return {iterator(n), true};
+    }
+
+    template<typename KK, typename M>
+    std::pair<iterator, bool> assign_unique(KK&& key, M&& obj) {
+        node* update[max_level];
+        node* n = descend(key, update);
+        if (n != head() && !comp_(key, n->key)) {
+            *n->mapped = std::forward<M>(obj);
+            return {iterator(n), false};
+        }
+        n = create_node(random_level(), std::forward<KK>(key), std::forward<M>(obj));
+        link_after(n, update);
+        return {iterator(n), true};
+    }
+
+    // Builds the node and its out-of-line value. Nothing is linked, so a
+    // throwing constructor leaves the map untouched.
+    template<typename KK, typename... Args>
+    node* create_node(int height, KK&& key, Args&&... args) {
+        std::size_t bucket = static_cast<std::size_t>(height) - 1;
+        node* n = ::new (pool_.allocate(bucket)) node;
+        n->height = height;
+        key_allocator key_alloc(pool_.allocator());
+        mapped_allocator value_alloc(pool_.allocator());
+        void* slot = nullptr;
+        try {
+            std::allocator_traits<key_allocator>::construct(key_alloc, std::addressof(n->key), std::forward<KK>(key));
+            try {
+                slot = mapped_pool_.allocate(mapped_alloc_);
+                n->mapped = static_cast<V*>(slot);
+                std::allocator_traits<mapped_allocator>::construct(value_alloc, n->mapped,
+                                                                    std::forward<Args>(args)...);
+            } catch (...) {
+                if (slot) {
+                    mapped_pool_.deallocate(slot);
+                }
+                std::allocator_traits<key_allocator>::destroy(key_alloc, std::addressof(n->key));
+                throw;
+            }
+        } catch (...) {
+            pool_.deallocate(bucket, n);
+            throw;
+        }
+        return n;
+    }
+
+    void destroy_node(node* n) noexcept {
+        key_allocator key_alloc(pool_.allocator());
+        mapped_allocator value_alloc(pool_.allocator());
+        std::allocator_traits<mapped_allocator>::destroy(value_alloc, n->mapped);
+        mapped_pool_.deallocate(n->mapped);
+        std::allocator_traits<key_allocator>::destroy(key_alloc, std::addressof(n->key));
+        std::size_t bucket = static_cast<std::size_t>(n->height) - 1;
+        n->~node();
+        pool_.deallocate(bucket, n);
+    }
+
+    // Links n right after update[i] on each of its levels and advances
+    // update to n.
+    void link_after(node* n, node** update) noexcept {
+        if (n->height > level) {
+            std::fill(update + level, update + n->height, head());
+            level = n->height;
+        }
+        n->prev = update[0];
+        for (int i = 0; i < n->height; ++i) {
+            n->next(i) = update[i]->next(i);
+            update[i]->next(i) = n;
+            update[i] = n;
+        }
+        n->next(0)->prev = n;
+        ++size_;
+    }
+
+    // Keys are unique, so the predecessor on every level is the last node
+    // with a smaller key.
+    void unlink(node* n) noexcept {
+        node* update[max_level];
+        descend(n->key, update);
+        for (int i = 0; i < n->height; ++i) {
+            update[i]->next(i) = n->next(i);
+        }
+        n->next(0)->prev = n->prev;
+        while (level > 1 && head()->next(level - 1) == head()) {
+            --level;
+        }
+        --size_;
+    }
+
+    void destroy_values() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<K> || !std::is_trivially_destructible_v<V>) {
+            key_allocator key_alloc(pool_.allocator());
+            mapped_allocator value_alloc(pool_.allocator());
+            for (node* n = head()->next(0); n != head(); n = n->next(0)) {
+                std::allocator_traits<mapped_allocator>::destroy(value_alloc, n->mapped);
+                std::allocator_traits<key_allocator>::destroy(key_alloc, std::addressof(n->key));
+            }
+        }
+    }
+
+    // Takes the node structure of other, whose pools have already been
+    // transferred to this map, and leaves other empty.
+    void adopt_links(jump_list_map& other) noexcept {
+        if (other.size_ == 0) {
+            other.reset_head();
+            return;
+        }
+        node* old_head = other.head();
+        level = other.level;
+        size_ = other.size_;
+        for (int i = 0; i < level; ++i) {
+            head()->next(i) = old_head->next(i);
+        }
+        head()->prev = old_head->prev;
+        head()->next(0)->prev = head();
+        node* x = head();
+        for (int i = level - 1; i >= 0; --i) {
+            while (x->next(i) != old_head) {
+                x = x->next(i);
+            }
+            x->next(i) = head();
+        }
+        other.reset_head();
+    }
+
+    // Replaces the contents with those of other, whose allocator must
+    // compare equal unless PropagateAlloc is set, and leaves other empty.
+    template<bool PropagateAlloc>
+    void take(jump_list_map& other) noexcept {
+        clear();
+        comp_ = other.comp_;
+        levels_ = other.levels_;
+        pool_.template take<PropagateAlloc>(other.pool_);
+        if constexpr (PropagateAlloc) {
+            mapped_alloc_ = other.mapped_alloc_;
+        }
+        mapped_pool_ = std::move(other.mapped_pool_);
+        adopt_links(other);
+    }
+
+    [[no_unique_address]] Compare comp_;
+    pool_type pool_;
+    [[no_unique_address]] mapped_unit_allocator mapped_alloc_;
+    // Out-of-line mapped values, one block of sizeof(V) each.
+    jl_detail::slab_pool<mapped_unit_allocator> mapped_pool_;
+    alignas(node) unsigned char head_storage_[sizeof(node) + max_level * sizeof(node*)];
+    int level;
+    size_t size_;
+    [[no_unique_address]] level_policy levels_;
+};
+
+#endif // JUMP_LIST_MAP_H
@@ -0,0 +1,103 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+#ifndef JUMP_LIST_PARALLEL_H
+#define JUMP_LIST_PARALLEL_H
+
+#include "jump_list.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Parallel sweeps over any list with a partition(n) member (jump_list in
+// either layout). The list is cut into one part per thread; the calling
+// thread takes the first part and std::jthread workers the others. The
+// list must not be modified meanwhile, and a list with finger search
+// enabled is fine, since iteration does not touch the finger. If a call
+// throws, the other parts still run to completion and the first exception
+// (by part) is rethrown.
+
+namespace jl_detail {
+
+// threads == 0 means one per hardware thread.
+inline std::size_t worker_count(unsigned threads) noexcept {
+    return threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Runs task(i) for every i in [0, n), task(0) on the calling thread.
+template<typename Task>
+void run_parts(std::size_t n, Task& task) {
+    std::vector<std::exception_ptr> errors(n);
+    auto run = [&](std::size_t i) {
+        try {
+            task(i);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(n > 0 ? n - 1 : 0);
+        for (std::size_t i = 1; i < n; ++i) {
+            workers.emplace_back(run, i);
+        }
+        if (n > 0) {
+            run(0);
+        }
+    }
+    for (auto& e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
+} // namespace jl_detail
+
+// Calls f on every element, concurrently from up to threads threads.
+template<typename List, typename F>
+    requires std::invocable<F&, typename List::const_reference>
+void parallel_for_each(const List& list, F f, unsigned threads = 0) {
+    auto parts = list.partition(jl_detail::worker_count(threads));
+    auto task = [&](std::size_t i) {
+        F local = f;
+        for (const auto& v : parts[i]) {
+            std::invoke(local, v);
+        }
+    };
+    jl_detail::run_parts(parts.size(), task);
+}
+
+// init combined with transform(x) for every element x through op, which
+// must be associative and commutative: each part is folded on its own
+// thread, then the partial results are folded into init in order.
+template<typename List, typename T, typename BinaryOp, typename UnaryOp = std::identity>
+    requires std::invocable<UnaryOp&, typename List::const_reference>
+T parallel_reduce(const List& list, T init, BinaryOp op, UnaryOp transform = {}, unsigned threads = 0) {
+    auto parts = list.partition(jl_detail::worker_count(threads));
+    std::vector<std::optional<T>> partial(parts.size());
+    auto task = [&](std::size_t i) {
+        BinaryOp local_op = op;
+        UnaryOp local_transform = transform;
+        auto it = parts[i].begin();
+        T acc(std::invoke(local_transform, *it));
+        for (++it; it != parts[i].end(); ++it) {
+            acc = std::invoke(local_op, std::move(acc), std::invoke(local_transform, *it));
+        }
+        partial[i].emplace(std::move(acc));
+    };
+    jl_detail::run_parts(parts.size(), task);
+    for (auto& p : partial) {
+        init = std::invoke(op, std::move(init), std::move(*p));
+    }
+    return init;
+}
+
+#endif // JUMP_LIST_PARALLEL_H
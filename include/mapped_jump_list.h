@@ -0,0 +1,507 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+#ifndef MAPPED_JUMP_LIST_H
+#define MAPPED_JUMP_LIST_H
+
+#include "jump_list.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace jl_detail {
+
+[[noreturn]] inline void throw_errno(const char* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// A file opened read-write and mapped shared in its entirety. Resizing
+// may move the mapping, so users address the contents by offset.
+class file_mapping {
+public:
+    explicit file_mapping(const std::filesystem::path& path) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            throw_errno("open");
+        }
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            int err = errno;
+            ::close(fd_);
+            throw std::system_error(err, std::generic_category(), "fstat");
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ != 0) {
+            map();
+        }
+    }
+
+    file_mapping(const file_mapping&) = delete;
+    file_mapping& operator=(const file_mapping&) = delete;
+
+    file_mapping(file_mapping&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1)), base_(std::exchange(other.base_, nullptr)),
+          size_(std::exchange(other.size_, 0)) {}
+
+    file_mapping& operator=(file_mapping&& other) noexcept {
+        if (this != &other) {
+            close();
+            fd_ = std::exchange(other.fd_, -1);
+            base_ = std::exchange(other.base_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~file_mapping() { close(); }
+
+    std::byte* data() const noexcept { return base_; }
+    std::size_t size() const noexcept { return size_; }
+
+    // Grows the file to bytes and remaps it.
+    void resize(std::size_t bytes) {
+        if (::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            throw_errno("ftruncate");
+        }
+        if (base_) {
+#if defined(MREMAP_MAYMOVE)
+            void* p = ::mremap(base_, size_, bytes, MREMAP_MAYMOVE);
+            if (p == MAP_FAILED) {
+                throw_errno("mremap");
+            }
+            base_ = static_cast<std::byte*>(p);
+            size_ = bytes;
+            return;
+#else
+            ::munmap(base_, size_);
+            base_ = nullptr;
+#endif
+        }
+        size_ = bytes;
+        map();
+    }
+
+    // Writes dirty pages back and waits for the device.
+    void sync() const {
+        if (base_ && ::msync(base_, size_, MS_SYNC) != 0) {
+            throw_errno("msync");
+        }
+    }
+
+private:
+    void map() {
+        void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            throw_errno("mmap");
+        }
+        base_ = static_cast<std::byte*>(p);
+    }
+
+    void close() noexcept {
+        if (base_) {
+            ::munmap(base_, size_);
+            base_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    int fd_ = -1;
+    std::byte* base_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace jl_detail
+
+// Ordered multiset like jump_list whose nodes live in a memory-mapped file.
+// Towers link by Offset, counted in 8-byte granules from the start of the
+// mapping, so the file is valid wherever it is mapped: opening an existing
+// file makes its contents available at once, with no deserialization.
+// std::uint32_t offsets address 32 GiB; std::uint64_t has no practical
+// limit.
+//
+// The file starts with a header recording the format version and the
+// layout (element size and alignment, offset width, tower limit, byte
+// order); opening a file written with a different layout throws. The
+// ordering is not recorded, so Compare has to be the one the file was
+// built with. Elements are stored as raw bytes and must be trivially
+// copyable, without pointers into memory outside the file.
+//
+// Changes reach the file through the shared mapping as the kernel writes
+// pages back; flush() forces them to disk. Nothing is done to keep the file
+// consistent across a crash in the middle of an update.
+template<typename T, typename Compare = std::less<T>, typename Offset = std::uint32_t>
+    requires jump_list_comparator<Compare, T> && std::is_trivially_copyable_v<T> &&
+             (std::same_as<Offset, std::uint32_t> || std::same_as<Offset, std::uint64_t>)
+class mapped_jump_list {
+    static constexpr std::size_t granule = 8;
+    static constexpr int max_level = jl_detail::max_level;
+    static constexpr std::uint32_t format_version = 1;
+    static constexpr char format_magic[8] = {'J', 'M', 'P', 'L', 'I', 'S', 'T', '\0'};
+
+    static_assert(alignof(T) <= granule, "elements must not need more than 8-byte alignment");
+
+    // value, then the bookkeeping fields and `height` links. A free node
+    // keeps the next free node of its height in prev.
+    struct node {
+        T value;
+        Offset prev;
+        std::uint32_t height;
+
+        Offset* links() noexcept { return reinterpret_cast<Offset*>(this + 1); }
+    };
+
+    static constexpr std::size_t node_bytes(int height) noexcept {
+        return (sizeof(node) + height * sizeof(Offset) + granule - 1) / granule * granule;
+    }
+
+    static constexpr std::size_t head_bytes =
+        (sizeof(node) + max_level * sizeof(Offset) + granule - 1) / granule * granule;
+
+    struct alignas(granule) header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t header_bytes;
+        std::uint32_t value_size;
+        std::uint32_t value_align;
+        std::uint32_t offset_size;
+        std::uint32_t max_height;
+        std::uint32_t byte_order;
+        std::uint32_t level;
+        std::uint64_t size;
+        // First granule never handed out.
+        std::uint64_t bump;
+        Offset free[max_level];
+        alignas(std::max(alignof(node), granule)) unsigned char head[head_bytes];
+    };
+
+    static constexpr std::uint32_t byte_order_mark = 0x01020304;
+    static constexpr std::size_t page_bytes = 4096;
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using reference = const T&;
+    using const_reference = const T&;
+    using offset_type = Offset;
+
+    // Iterators hold an offset, so they stay valid when the file grows and
+    // the mapping moves.
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using iterator_concept = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() noexcept = default;
+
+        reference operator*() const noexcept { return list_->at(off_)->value; }
+        pointer operator->() const noexcept { return std::addressof(**this); }
+
+        const_iterator& operator++() noexcept {
+            off_ = list_->at(off_)->links()[0];
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        const_iterator& operator--() noexcept {
+            off_ = list_->at(off_)->prev;
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept {
+            const_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        friend bool operator==(const const_iterator&, const const_iterator&) = default;
+
+    private:
+        friend class mapped_jump_list;
+
+        const_iterator(const mapped_jump_list* list, Offset off) noexcept : list_(list), off_(off) {}
+
+        const mapped_jump_list* list_ = nullptr;
+        Offset off_ = 0;
+    };
+
+    using iterator = const_iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // Opens path, creating an empty list of initial_bytes if the file is
+    // empty or missing. Throws std::system_error when the file cannot be
+    // opened or mapped and std::runtime_error when it holds something else
+    // than a list of this layout.
+    explicit mapped_jump_list(const std::filesystem::path& path, std::size_t initial_bytes = std::size_t{1} << 20,
+                              const Compare& comp = Compare())
+        : comp_(comp), map_(path) {
+        if (map_.size() == 0) {
+            create(initial_bytes);
+        } else {
+            validate();
+        }
+    }
+
+    mapped_jump_list(const mapped_jump_list&) = delete;
+    mapped_jump_list& operator=(const mapped_jump_list&) = delete;
+
+    mapped_jump_list(mapped_jump_list&&) noexcept = default;
+    mapped_jump_list& operator=(mapped_jump_list&&) noexcept = default;
+
+    ~mapped_jump_list() = default;
+
+    // Iterators
+
+    const_iterator begin() const noexcept { return const_iterator(this, head()->links()[0]); }
+    const_iterator end() const noexcept { return const_iterator(this, head_offset()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept { return hdr()->size == 0; }
+    size_type size() const noexcept { return static_cast<size_type>(hdr()->size); }
+
+    // Bytes of the file in use and mapped.
+    std::size_t used_bytes() const noexcept { return static_cast<std::size_t>(hdr()->bump) * granule; }
+    std::size_t mapped_bytes() const noexcept { return map_.size(); }
+
+    // Modifiers
+
+    // Forgets every element; the file keeps its size for reuse.
+    void clear() noexcept { reset(); }
+
+    // The element goes after its equivalents. May grow the file.
+    iterator insert(const T& value) {
+        T v = value;
+        int height = levels_(std::min(static_cast<int>(std::bit_width(size())) + 1, max_level));
+        Offset off = allocate(height);
+        node* n = at(off);
+        std::memcpy(static_cast<void*>(std::addressof(n->value)), std::addressof(v), sizeof(T));
+        n->height = static_cast<std::uint32_t>(height);
+        node* update[max_level];
+        descend([&](node* x) { return !comp_(n->value, x->value); }, update);
+        header* h = hdr();
+        if (height > static_cast<int>(h->level)) {
+            std::fill(update + h->level, update + height, head());
+            h->level = static_cast<std::uint32_t>(height);
+        }
+        n->prev = offset_of(update[0]);
+        for (int i = 0; i < height; ++i) {
+            n->links()[i] = update[i]->links()[i];
+            update[i]->links()[i] = off;
+        }
+        at(n->links()[0])->prev = off;
+        ++h->size;
+        return iterator(this, off);
+    }
+
+    iterator erase(const_iterator pos) {
+        node* n = at(pos.off_);
+        Offset next = n->links()[0];
+        node* update[max_level];
+        descend([&](node* x) { return comp_(x->value, n->value); }, update);
+        header* h = hdr();
+        for (int i = 0; i < static_cast<int>(n->height); ++i) {
+            node* x = update[i];
+            while (x->links()[i] != pos.off_) {
+                x = at(x->links()[i]);
+            }
+            x->links()[i] = n->links()[i];
+        }
+        at(next)->prev = n->prev;
+        while (h->level > 1 && head()->links()[h->level - 1] == head_offset()) {
+            --h->level;
+        }
+        --h->size;
+        n->prev = h->free[n->height - 1];
+        h->free[n->height - 1] = pos.off_;
+        return iterator(this, next);
+    }
+
+    size_type erase(const T& key) {
+        size_type erased = 0;
+        for (auto it = find(key); it != end() && !comp_(key, *it); ++erased) {
+            it = erase(it);
+        }
+        return erased;
+    }
+
+    // Writes every change so far to the file and waits for the device.
+    void flush() const { map_.sync(); }
+
+    // Lookup
+
+    size_type count(const T& key) const {
+        auto [first, last] = equal_range(key);
+        return static_cast<size_type>(std::distance(first, last));
+    }
+
+    iterator find(const T& key) const {
+        iterator it = lower_bound(key);
+        return it != end() && !comp_(key, *it) ? it : end();
+    }
+
+    bool contains(const T& key) const { return find(key) != end(); }
+
+    iterator lower_bound(const T& key) const {
+        node* update[max_level];
+        descend([&](node* x) { return comp_(x->value, key); }, update);
+        return iterator(this, update[0]->links()[0]);
+    }
+
+    iterator upper_bound(const T& key) const {
+        node* update[max_level];
+        descend([&](node* x) { return !comp_(key, x->value); }, update);
+        return iterator(this, update[0]->links()[0]);
+    }
+
+    std::pair<iterator, iterator> equal_range(const T& key) const { return {lower_bound(key), upper_bound(key)}; }
+
+    // Observers
+
+    key_compare key_comp() const { return comp_; }
+    value_compare value_comp() const { return comp_; }
+
+private:
+    header* hdr() const noexcept { return reinterpret_cast<header*>(map_.data()); }
+
+    node* at(Offset off) const noexcept { return reinterpret_cast<node*>(map_.data() + std::size_t{off} * granule); }
+
+    Offset offset_of(const node* n) const noexcept {
+        return static_cast<Offset>((reinterpret_cast<const std::byte*>(n) - map_.data()) / granule);
+    }
+
+    static constexpr Offset head_offset() noexcept { return static_cast<Offset>(offsetof(header, head) / granule); }
+
+    node* head() const noexcept { return at(head_offset()); }
+
+    template<typename Before>
+    void descend(Before before, node** update) const {
+        node* h = head();
+        node* x = h;
+        for (int i = static_cast<int>(hdr()->level) - 1; i >= 0; --i) {
+            for (node* y = at(x->links()[i]); y != h && before(y); y = at(x->links()[i])) {
+                x = y;
+            }
+            update[i] = x;
+        }
+    }
+
+    // Takes a node from the free list of its height or from the end of the
+    // used space, growing the file by doubling when that runs out.
+    Offset allocate(int height) {
+        std::size_t bucket = static_cast<std::size_t>(height) - 1;
+        if (Offset off = hdr()->free[bucket]) {
+            hdr()->free[bucket] = at(off)->prev;
+            return off;
+        }
+        std::size_t bytes = node_bytes(height);
+        std::size_t need = used_bytes() + bytes;
+        if (need > map_.size()) {
+            std::size_t grown = std::max(need, map_.size() * 2);
+            grown = (grown + page_bytes - 1) / page_bytes * page_bytes;
+            if ((grown - 1) / granule > std::numeric_limits<Offset>::max()) {
+                grown = (std::size_t{std::numeric_limits<Offset>::max()} + 1) * granule;
+                if (need > grown) {
+                    throw std::length_error("mapped_jump_list: offsets exhausted");
+                }
+            }
+            map_.resize(grown);
+        }
+        Offset off = static_cast<Offset>(hdr()->bump);
+        hdr()->bump += bytes / granule;
+        return off;
+    }
+
+    void create(std::size_t initial_bytes) {
+        std::size_t bytes = std::max(initial_bytes, sizeof(header) + node_bytes(1));
+        map_.resize((bytes + page_bytes - 1) / page_bytes * page_bytes);
+        header* h = hdr();
+        std::memset(static_cast<void*>(h), 0, sizeof(header));
+        std::memcpy(h->magic, format_magic, sizeof(format_magic));
+        h->version = format_version;
+        h->header_bytes = sizeof(header);
+        h->value_size = sizeof(T);
+        h->value_align = alignof(T);
+        h->offset_size = sizeof(Offset);
+        h->max_height = max_level;
+        h->byte_order = byte_order_mark;
+        reset();
+    }
+
+    void reset() noexcept {
+        header* h = hdr();
+        h->level = 1;
+        h->size = 0;
+        h->bump = (sizeof(header) + granule - 1) / granule;
+        std::fill(std::begin(h->free), std::end(h->free), Offset{0});
+        node* hd = head();
+        hd->height = max_level;
+        hd->prev = head_offset();
+        std::fill(hd->links(), hd->links() + max_level, head_offset());
+    }
+
+    void validate() const {
+        auto fail = [](const char* why) { throw std::runtime_error(std::string("mapped_jump_list: ") + why); };
+        if (map_.size() < sizeof(header)) {
+            fail("file is too small for a header");
+        }
+        const header* h = hdr();
+        if (std::memcmp(h->magic, format_magic, sizeof(format_magic)) != 0) {
+            fail("not a jump_list file");
+        }
+        if (h->byte_order != byte_order_mark) {
+            fail("file was written with a different byte order");
+        }
+        if (h->version != format_version) {
+            fail("unsupported format version");
+        }
+        if (h->header_bytes != sizeof(header) || h->value_size != sizeof(T) || h->value_align != alignof(T) ||
+            h->offset_size != sizeof(Offset) || h->max_height != static_cast<std::uint32_t>(max_level)) {
+            fail("file was written with a different element type or layout");
+        }
+        if (h->level < 1 || h->level > static_cast<std::uint32_t>(max_level) || h->bump * granule > map_.size()) {
+            fail("header is corrupt");
+        }
+    }
+
+    [[no_unique_address]] Compare comp_;
+    jl_detail::file_mapping map_;
+    [[no_unique_address]] geometric_levels<> levels_;
+};
+
+#endif // MAPPED_JUMP_LIST_H
@@ -0,0 +1,410 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+#ifndef SHARDED_JUMP_LIST_H
+#define SHARDED_JUMP_LIST_H
+
+#include "epoch_reclamation.h"
+#include "jump_list.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Ordered multiset split by key range into Shards plain-layout jump_lists,
+// each behind its own std::shared_mutex, so writers to different ranges
+// never wait for each other and readers of one range share its lock.
+//
+// The boundaries live in an immutable routing table published through an
+// atomic pointer. An operation pins the epoch, picks its shard by binary
+// search over the table, locks the shard and checks that the table has not
+// been replaced meanwhile, retrying if it has; the old table is retired to
+// epoch_domain. Readers therefore never write a cache line shared between
+// shards.
+//
+// A shard that has grown past split_threshold and holds over half as many
+// elements again as its smaller neighbour hands that neighbour enough of its
+// elements at the facing end to even them out (split() and merge(), so the
+// nodes are relinked rather than copied), moving the boundary between them;
+// the neighbour then checks its own other side. A new list routes
+// everything to the first shard until it splits; pass boundaries to the
+// constructor when the key distribution is known. Equivalent elements
+// always share a shard.
+//
+// Iteration visits the shards in key order. Each iterator holds a shared
+// lock on the shard it is in and takes the next one before releasing it, so
+// it sees every element that is not inserted or erased meanwhile exactly
+// once, even while boundaries move. While an iterator is alive its thread
+// must not call other members of the list.
+template<typename T, std::size_t Shards = 16, typename Compare = std::less<T>,
+         typename Allocator = std::allocator<T>, typename Traits = jump_list_traits>
+    requires jump_list_comparator<Compare, T> && std::copy_constructible<T>
+class sharded_jump_list {
+    static_assert(Shards >= 1, "sharded_jump_list needs at least one shard");
+    static_assert(Traits::keys_per_node == 1 && !Traits::compact_links, "sharded_jump_list needs the plain layout");
+
+public:
+    using list_type = jump_list<T, Compare, Allocator, Traits>;
+    using value_type = T;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    using const_reference = const T&;
+
+    static constexpr size_type default_split_threshold = size_type{1} << 14;
+
+    // Ordered scan across the shards; see the class comment for the
+    // locking. Move-only, compared against std::default_sentinel.
+    class const_iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = const T&;
+
+        const_iterator(const_iterator&&) noexcept = default;
+        const_iterator& operator=(const_iterator&&) noexcept = default;
+
+        reference operator*() const noexcept { return *it_; }
+        const T* operator->() const noexcept { return std::addressof(*it_); }
+
+        const_iterator& operator++() {
+            ++it_;
+            settle();
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const const_iterator& i, std::default_sentinel_t) noexcept {
+            return i.index_ == Shards;
+        }
+
+    private:
+        friend class sharded_jump_list;
+
+        const_iterator(const sharded_jump_list* owner, std::shared_lock<std::shared_mutex>&& lock, size_type index,
+                       typename list_type::const_iterator it)
+            : owner_(owner), lock_(std::move(lock)), index_(index), it_(it) {
+            settle();
+        }
+
+        // Moves past exhausted shards, coupling the locks.
+        void settle() {
+            while (it_ == owner_->shards_[index_].list.end()) {
+                if (++index_ == Shards) {
+                    lock_ = {};
+                    return;
+                }
+                lock_ = std::shared_lock(owner_->shards_[index_].mutex);
+                it_ = owner_->shards_[index_].list.begin();
+            }
+        }
+
+        const sharded_jump_list* owner_;
+        std::shared_lock<std::shared_mutex> lock_;
+        size_type index_;
+        typename list_type::const_iterator it_;
+    };
+
+    using iterator = const_iterator;
+
+    explicit sharded_jump_list(size_type split_threshold = default_split_threshold, const Compare& comp = Compare(),
+                               const Allocator& alloc = Allocator())
+        : sharded_jump_list(std::vector<T>(), split_threshold, comp, alloc) {}
+
+    // Starts with shard i + 1 holding the keys not less than boundaries[i].
+    // At most Shards - 1 boundaries, in ascending order; missing ones leave
+    // the last shards empty until a split reaches them.
+    explicit sharded_jump_list(const std::vector<T>& boundaries, size_type split_threshold = default_split_threshold,
+                               const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : comp_(comp), split_threshold_(std::max<size_type>(split_threshold, 2)) {
+        if (boundaries.size() >= Shards) {
+            throw std::invalid_argument("sharded_jump_list: too many boundaries");
+        }
+        if (std::ranges::adjacent_find(boundaries, [&](const T& a, const T& b) { return !comp_(a, b); }) !=
+            boundaries.end()) {
+            throw std::invalid_argument("sharded_jump_list: boundaries must ascend");
+        }
+        for (auto& s : shards_) {
+            s.list = list_type(comp, alloc);
+        }
+        auto table = std::make_unique<routing>();
+        table->bounds.assign(boundaries.begin(), boundaries.end());
+        table->bounds.resize(Shards - 1);
+        routing_.store(table.release(), std::memory_order_release);
+    }
+
+    sharded_jump_list(const sharded_jump_list&) = delete;
+    sharded_jump_list& operator=(const sharded_jump_list&) = delete;
+
+    ~sharded_jump_list() { delete routing_.load(std::memory_order_relaxed); }
+
+    // Modifiers
+
+    void insert(const T& value) { insert_value(value); }
+
+    void insert(T&& value) { insert_value(std::move(value)); }
+
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    void emplace(Args&&... args) {
+        insert_value(T(std::forward<Args>(args)...));
+    }
+
+    size_type erase(const T& key) {
+        auto [lock, index] = lock_for<true>(key);
+        shard& s = shards_[index];
+        size_type n = s.list.erase(key);
+        s.publish_size();
+        return n;
+    }
+
+    void clear() {
+        std::lock_guard rebalancing(rebalance_mutex_);
+        for (auto& s : shards_) {
+            std::unique_lock lock(s.mutex);
+            s.list.clear();
+            s.publish_size();
+        }
+    }
+
+    // Lookup
+
+    bool contains(const T& key) const { return contains_key(key); }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    bool contains(const K& key) const {
+        return contains_key(key);
+    }
+
+    size_type count(const T& key) const { return count_key(key); }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    size_type count(const K& key) const {
+        return count_key(key);
+    }
+
+    // A copy of the first element equivalent to key, if any.
+    std::optional<T> find(const T& key) const { return find_key(key); }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    std::optional<T> find(const K& key) const {
+        return find_key(key);
+    }
+
+    // Iterators
+
+    const_iterator begin() const {
+        return const_iterator(this, std::shared_lock(shards_[0].mutex), 0, shards_[0].list.begin());
+    }
+
+    std::default_sentinel_t end() const noexcept { return std::default_sentinel; }
+
+    // Scan from the first element not less than key.
+    const_iterator lower_bound(const T& key) const {
+        auto [lock, index] = lock_for<false>(key);
+        auto it = shards_[index].list.lower_bound(key);
+        return const_iterator(this, std::move(lock), index, it);
+    }
+
+    // Capacity
+
+    // Exact when no writer is running.
+    size_type size() const noexcept {
+        size_type n = 0;
+        for (auto& s : shards_) {
+            n += s.size.load(std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    // Elements per shard, in key order.
+    std::array<size_type, Shards> shard_sizes() const noexcept {
+        std::array<size_type, Shards> sizes{};
+        for (size_type i = 0; i < Shards; ++i) {
+            sizes[i] = shards_[i].size.load(std::memory_order_relaxed);
+        }
+        return sizes;
+    }
+
+    size_type split_threshold() const noexcept { return split_threshold_; }
+
+    key_compare key_comp() const { return comp_; }
+
+private:
+    // An overfull shard compares itself with its neighbours once per this
+    // many inserts, so most inserts never read another shard's counter.
+    static constexpr size_type rebalance_interval = 256;
+
+    // Aligned so that neighbouring locks do not share a cache line.
+    struct alignas(64) shard {
+        mutable std::shared_mutex mutex;
+        list_type list;
+        // list.size(), for readers that do not hold the lock.
+        std::atomic<size_type> size{0};
+        // Inserts since the shard last compared itself with its neighbours.
+        size_type unchecked = 0;
+
+        size_type publish_size() noexcept {
+            size_type n = list.size();
+            size.store(n, std::memory_order_relaxed);
+            return n;
+        }
+    };
+
+    // bounds[i] is the least key of shard i + 1; an empty bound stands for
+    // one above every key, and only a suffix of bounds is empty.
+    struct routing {
+        std::vector<std::optional<T>> bounds;
+
+        template<typename K>
+        size_type route(const K& key, const Compare& comp) const {
+            auto it = std::ranges::partition_point(
+                bounds, [&](const std::optional<T>& b) { return b && !comp(key, *b); });
+            return static_cast<size_type>(it - bounds.begin());
+        }
+    };
+
+    template<bool Exclusive>
+    using lock_type = std::conditional_t<Exclusive, std::unique_lock<std::shared_mutex>,
+                                         std::shared_lock<std::shared_mutex>>;
+
+    // Locks the shard that owns key under the current routing table.
+    template<bool Exclusive, typename K>
+    std::pair<lock_type<Exclusive>, size_type> lock_for(const K& key) const {
+        for (;;) {
+            epoch_guard guard;
+            const routing* table = routing_.load(std::memory_order_acquire);
+            size_type index = table->route(key, comp_);
+            lock_type<Exclusive> lock(shards_[index].mutex);
+            if (routing_.load(std::memory_order_acquire) == table) {
+                return {std::move(lock), index};
+            }
+        }
+    }
+
+    template<typename V>
+    void insert_value(V&& value) {
+        size_type index;
+        bool check;
+        {
+            auto [lock, i] = lock_for<true>(value);
+            index = i;
+            shard& s = shards_[index];
+            s.list.insert(std::forward<V>(value));
+            check = s.publish_size() > split_threshold_ && ++s.unchecked >= rebalance_interval;
+            if (check) {
+                s.unchecked = 0;
+            }
+        }
+        // A shard that received elements may now outweigh its other neighbour.
+        for (size_type step = 0; check && step < Shards && index < Shards; ++step) {
+            index = rebalance(index);
+        }
+    }
+
+    template<typename K>
+    bool contains_key(const K& key) const {
+        auto [lock, index] = lock_for<false>(key);
+        return shards_[index].list.contains(key);
+    }
+
+    template<typename K>
+    size_type count_key(const K& key) const {
+        auto [lock, index] = lock_for<false>(key);
+        return shards_[index].list.count(key);
+    }
+
+    template<typename K>
+    std::optional<T> find_key(const K& key) const {
+        auto [lock, index] = lock_for<false>(key);
+        const list_type& list = shards_[index].list;
+        auto it = list.find(key);
+        if (it == list.end()) {
+            return std::nullopt;
+        }
+        return *it;
+    }
+
+    // If shard i holds over half as many elements again as its smaller
+    // neighbour, moves the boundary between them so that they end up about
+    // even, and returns the neighbour; otherwise returns Shards. One
+    // rebalance runs at a time; a shard that finds another in progress tries
+    // again rebalance_interval inserts later.
+    size_type rebalance(size_type i) {
+        if constexpr (Shards > 1) {
+            std::unique_lock rebalancing(rebalance_mutex_, std::try_to_lock);
+            if (!rebalancing) {
+                return Shards;
+            }
+            size_type j;
+            if (i == 0) {
+                j = 1;
+            } else if (i + 1 == Shards) {
+                j = i - 1;
+            } else {
+                j = shards_[i - 1].size.load(std::memory_order_relaxed) <=
+                            shards_[i + 1].size.load(std::memory_order_relaxed)
+                        ? i - 1
+                        : i + 1;
+            }
+            size_type low = std::min(i, j);
+            std::unique_lock first(shards_[low].mutex);
+            std::unique_lock second(shards_[low + 1].mutex);
+            list_type& from = shards_[i].list;
+            list_type& to = shards_[j].list;
+            if (from.size() <= split_threshold_ || to.size() * 3 >= from.size() * 2) {
+                return Shards;
+            }
+            // Cut off the excess at the end facing the neighbour.
+            size_type excess = (from.size() - to.size()) / 2;
+            auto parts = from.partition(std::max<size_type>(2, from.size() / excess));
+            if (parts.size() < 2) {
+                return Shards;
+            }
+            const T& cut = j > i ? *parts.back().begin() : *parts[1].begin();
+            if (!comp_(*from.begin(), cut)) {
+                // The cut falls among the equivalents of the first element.
+                return Shards;
+            }
+            epoch_guard guard;
+            routing* old = routing_.load(std::memory_order_relaxed);
+            auto table = std::make_unique<routing>(*old);
+            table->bounds[low] = cut;
+            list_type moved = from.split(*table->bounds[low]);
+            if (j < i) {
+                from.swap(moved);
+            }
+            to.merge(moved);
+            shards_[i].publish_size();
+            shards_[j].publish_size();
+            routing_.store(table.release(), std::memory_order_release);
+            epoch_domain::global().retire(old);
+            return j;
+        } else {
+            return Shards;
+        }
+    }
+
+    [[no_unique_address]] Compare comp_;
+    size_type split_threshold_;
+    std::array<shard, Shards> shards_;
+    std::atomic<routing*> routing_{nullptr};
+    std::mutex rebalance_mutex_;
+};
+
+#endif // SHARDED_JUMP_LIST_H
@@ -0,0 +1,488 @@
+// Anisimov Vasiliy st129629@student.spbu.ru
+// Laboratory Work 2
+
+#ifndef SMALL_JUMP_LIST_H
+#define SMALL_JUMP_LIST_H
+
+#include "jump_list.h"
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Ordered multiset for sets that are usually small. Up to N elements live
+// sorted in an array inside the object, searched with the vector kernels
+// of the fat layout when N and T allow it (a binary search otherwise), so
+// such a set never allocates and never draws a tower height. The insertion
+// that would make it N + 1 long moves the elements into a jump_list built
+// by the linear sorted bulk path; the set stays a jump_list from then on
+// until clear(). Traits configure that list; the default caps its towers
+// at 16 levels, which serves up to about 64K elements at full speed and
+// keeps the list's head and pool small.
+//
+// Inserting or erasing invalidates iterators while the elements are
+// inline, and promotion invalidates all of them.
+template<typename T, std::size_t N, typename Compare = std::less<T>, typename Allocator = std::allocator<T>,
+         typename Traits = capped_level_traits<16>>
+    requires jump_list_comparator<Compare, T> && (N > 0)
+class small_jump_list {
+    using list_type = jump_list<T, Compare, Allocator, Traits>;
+    using list_iterator = typename list_type::const_iterator;
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using list_allocator = typename alloc_traits::template rebind_alloc<list_type>;
+    using list_alloc_traits = std::allocator_traits<list_allocator>;
+
+    // The kernels read every one of the N slots, so they are used only when
+    // they step through N evenly; the slots are then zeroed up front.
+    static constexpr bool vector_search =
+        jl_detail::simd_key<T> && jl_detail::simd_order<Compare, T> != 0 && N % 8 == 0 && N <= 64;
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = typename alloc_traits::pointer;
+    using const_pointer = typename alloc_traits::const_pointer;
+
+    static constexpr size_type inline_capacity = N;
+
+    // A pointer into the inline array, or a jump_list iterator once the set
+    // has been promoted.
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() noexcept = default;
+
+        reference operator*() const noexcept { return p_ ? *p_ : *it_; }
+        pointer operator->() const noexcept { return p_ ? p_ : std::addressof(*it_); }
+
+        const_iterator& operator++() noexcept {
+            if (p_) {
+                ++p_;
+            } else {
+                ++it_;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        const_iterator& operator--() noexcept {
+            if (p_) {
+                --p_;
+            } else {
+                --it_;
+            }
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept {
+            const_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        friend bool operator==(const const_iterator&, const const_iterator&) = default;
+
+    private:
+        friend class small_jump_list;
+
+        explicit const_iterator(const T* p) noexcept : p_(p) {}
+        explicit const_iterator(list_iterator it) noexcept : it_(it) {}
+
+        const T* p_ = nullptr;
+        list_iterator it_{};
+    };
+
+    using iterator = const_iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // Construction and destruction
+
+    small_jump_list() : small_jump_list(Compare()) {}
+
+    explicit small_jump_list(const Compare& comp, const Allocator& alloc = Allocator()) : comp_(comp), alloc_(alloc) {
+        if constexpr (vector_search) {
+            std::memset(storage_, 0, sizeof(storage_));
+        }
+    }
+
+    explicit small_jump_list(const Allocator& alloc) : small_jump_list(Compare(), alloc) {}
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    small_jump_list(It first, It last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : small_jump_list(comp, alloc) {
+        insert(first, last);
+    }
+
+    small_jump_list(std::initializer_list<T> init, const Compare& comp = Compare(),
+                    const Allocator& alloc = Allocator())
+        : small_jump_list(comp, alloc) {
+        insert(init);
+    }
+
+    small_jump_list(const small_jump_list& other)
+        : small_jump_list(other.comp_, alloc_traits::select_on_container_copy_construction(other.alloc_)) {
+        if (other.list_) {
+            list_ = make_list(*other.list_, alloc_);
+        } else {
+            append_inline(other.items(), other.items() + other.count_);
+        }
+    }
+
+    small_jump_list(small_jump_list&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : small_jump_list(other.comp_, other.alloc_) {
+        take(other);
+    }
+
+    ~small_jump_list() { reset(); }
+
+    small_jump_list& operator=(const small_jump_list& other) {
+        if (this != &other) {
+            constexpr bool propagate = alloc_traits::propagate_on_container_copy_assignment::value;
+            small_jump_list tmp(other.comp_, propagate ? other.alloc_ : alloc_);
+            if (other.list_) {
+                tmp.list_ = tmp.make_list(*other.list_, tmp.alloc_);
+            } else {
+                tmp.append_inline(other.items(), other.items() + other.count_);
+            }
+            reset();
+            comp_ = tmp.comp_;
+            alloc_ = tmp.alloc_;
+            take(tmp);
+        }
+        return *this;
+    }
+
+    // A promoted set hands over its list when the allocators allow it; an
+    // inline one moves its elements.
+    small_jump_list& operator=(small_jump_list&& other) noexcept(
+        (alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) &&
+        std::is_nothrow_move_constructible_v<T>) {
+        if (this == &other) {
+            return *this;
+        }
+        reset();
+        comp_ = other.comp_;
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            alloc_ = other.alloc_;
+        }
+        take(other);
+        return *this;
+    }
+
+    small_jump_list& operator=(std::initializer_list<T> init) {
+        *this = small_jump_list(init, comp_, alloc_);
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return alloc_; }
+
+    // Iterators
+
+    iterator begin() const noexcept { return list_ ? iterator(list_->begin()) : iterator(items()); }
+    iterator end() const noexcept { return list_ ? iterator(list_->end()) : iterator(items() + count_); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    reverse_iterator rbegin() const noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() const noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    size_type size() const noexcept { return list_ ? list_->size() : count_; }
+    size_type max_size() const noexcept {
+        return static_cast<size_type>(std::numeric_limits<difference_type>::max()) / sizeof(T);
+    }
+
+    // True while the elements are stored inline.
+    bool is_inline() const noexcept { return list_ == nullptr; }
+
+    // Modifiers
+
+    // Destroys the elements and the jump_list, if any, and returns to inline
+    // storage.
+    void clear() noexcept { reset(); }
+
+    iterator insert(const T& value) { return emplace(value); }
+    iterator insert(T&& value) { return emplace(std::move(value)); }
+
+    // The element is placed after its equivalents. The hint is not used.
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    iterator emplace(Args&&... args) {
+        if (list_) {
+            return iterator(list_->emplace(std::forward<Args>(args)...));
+        }
+        // Built before promotion, as args may refer to an inline element.
+        T v(std::forward<Args>(args)...);
+        if (count_ == N) {
+            promote();
+            return iterator(list_->emplace(std::move(v)));
+        }
+        T* a = items();
+        size_type pos = bound_index<true>(v);
+        if (pos == count_) {
+            std::construct_at(a + count_, std::move(v));
+        } else {
+            std::construct_at(a + count_, std::move(a[count_ - 1]));
+            std::move_backward(a + pos, a + count_ - 1, a + count_);
+            a[pos] = std::move(v);
+        }
+        ++count_;
+        return iterator(a + pos);
+    }
+
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    iterator emplace_hint(const_iterator, Args&&... args) {
+        return emplace(std::forward<Args>(args)...);
+    }
+
+    template<std::input_iterator It>
+        requires std::constructible_from<T, std::iter_reference_t<It>>
+    void insert(It first, It last) {
+        for (; first != last; ++first) {
+            emplace(*first);
+        }
+    }
+
+    void insert(std::initializer_list<T> init) { insert(init.begin(), init.end()); }
+
+    iterator erase(const_iterator pos) {
+        if (list_) {
+            return iterator(list_->erase(pos.it_));
+        }
+        return erase(pos, std::next(pos));
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        if (list_) {
+            return iterator(list_->erase(first.it_, last.it_));
+        }
+        T* a = items();
+        T* from = a + (first.p_ - a);
+        if (first == last) {
+            return iterator(from);
+        }
+        T* end = std::move(a + (last.p_ - a), a + count_, from);
+        std::destroy(end, a + count_);
+        count_ = static_cast<size_type>(end - a);
+        return iterator(from);
+    }
+
+    size_type erase(const T& key) {
+        auto [first, last] = equal_range(key);
+        size_type old_size = size();
+        erase(first, last);
+        return old_size - size();
+    }
+
+    void swap(small_jump_list& other) noexcept(std::is_nothrow_move_constructible_v<T> &&
+                                               std::is_nothrow_move_assignable_v<small_jump_list>) {
+        small_jump_list tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend void swap(small_jump_list& a, small_jump_list& b) noexcept(noexcept(a.swap(b))) { a.swap(b); }
+
+    // Lookup
+
+    size_type count(const T& key) const {
+        auto [first, last] = equal_range(key);
+        return static_cast<size_type>(std::distance(first, last));
+    }
+
+    iterator find(const T& key) const { return find_at(key); }
+
+    bool contains(const T& key) const { return find(key) != end(); }
+
+    iterator lower_bound(const T& key) const { return bound_at<false>(key); }
+    iterator upper_bound(const T& key) const { return bound_at<true>(key); }
+
+    std::pair<iterator, iterator> equal_range(const T& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // Heterogeneous lookup for transparent comparators, as in jump_list.
+
+    template<jump_list_lookup_key<Compare, T> K>
+    size_type count(const K& key) const {
+        auto [first, last] = equal_range(key);
+        return static_cast<size_type>(std::distance(first, last));
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator find(const K& key) const {
+        return find_at(key);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    bool contains(const K& key) const {
+        return find(key) != end();
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator lower_bound(const K& key) const {
+        return bound_at<false>(key);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    iterator upper_bound(const K& key) const {
+        return bound_at<true>(key);
+    }
+
+    template<jump_list_lookup_key<Compare, T> K>
+    std::pair<iterator, iterator> equal_range(const K& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // Observers
+
+    key_compare key_comp() const { return comp_; }
+    value_compare value_comp() const { return comp_; }
+
+    // Comparison
+
+    friend bool operator==(const small_jump_list& a, const small_jump_list& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    friend auto operator<=>(const small_jump_list& a, const small_jump_list& b) {
+        return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end(),
+                                                      jl_detail::synth_three_way{});
+    }
+
+private:
+    T* items() const noexcept { return std::launder(reinterpret_cast<T*>(const_cast<unsigned char*>(storage_))); }
+
+    // Index of the first inline element not before key (Upper: that key is
+    // before). K is T or a transparent lookup key.
+    template<bool Upper, typename K>
+    size_type bound_index(const K& key) const {
+        const T* a = items();
+        if constexpr (vector_search) {
+            return static_cast<size_type>(
+                jl_detail::block_bound<Upper, static_cast<int>(N)>(a, static_cast<int>(count_), key, comp_));
+        } else if constexpr (Upper) {
+            return static_cast<size_type>(std::upper_bound(a, a + count_, key, comp_) - a);
+        } else {
+            return static_cast<size_type>(std::lower_bound(a, a + count_, key, comp_) - a);
+        }
+    }
+
+    template<bool Upper, typename K>
+    iterator bound_at(const K& key) const {
+        if (list_) {
+            return iterator(Upper ? list_->upper_bound(key) : list_->lower_bound(key));
+        }
+        return iterator(items() + bound_index<Upper>(key));
+    }
+
+    template<typename K>
+    iterator find_at(const K& key) const {
+        iterator it = bound_at<false>(key);
+        return it != end() && !comp_(key, *it) ? it : end();
+    }
+
+    // Copies [first, last), sorted and at most N long, into the empty
+    // inline array.
+    void append_inline(const T* first, const T* last) {
+        std::uninitialized_copy(first, last, items());
+        count_ = static_cast<size_type>(last - first);
+    }
+
+    template<typename... Args>
+    list_type* make_list(Args&&... args) {
+        list_allocator alloc(alloc_);
+        list_type* l = list_alloc_traits::allocate(alloc, 1);
+        try {
+            ::new (static_cast<void*>(l)) list_type(std::forward<Args>(args)...);
+        } catch (...) {
+            list_alloc_traits::deallocate(alloc, l, 1);
+            throw;
+        }
+        return l;
+    }
+
+    // Moves the full inline array into a new jump_list in one linear pass:
+    // the sorted bulk build lays out balanced towers without any level
+    // draws. If that throws the set is left as it was.
+    void promote() {
+        T* a = items();
+        if constexpr (std::is_nothrow_move_constructible_v<T>) {
+            list_ = make_list(sorted_equivalent, std::make_move_iterator(a), std::make_move_iterator(a + count_),
+                              comp_, alloc_);
+        } else {
+            list_ = make_list(sorted_equivalent, a, a + count_, comp_, alloc_);
+        }
+        std::destroy(a, a + count_);
+        count_ = 0;
+    }
+
+    // Takes the contents of other, whose comparator has already been
+    // copied, and leaves it empty and inline.
+    void take(small_jump_list& other) {
+        if (!other.list_) {
+            T* a = other.items();
+            std::uninitialized_move(a, a + other.count_, items());
+            count_ = other.count_;
+            other.reset();
+        } else if (alloc_ == other.alloc_) {
+            list_ = std::exchange(other.list_, nullptr);
+        } else {
+            list_ = make_list(std::move(*other.list_), alloc_);
+            other.reset();
+        }
+    }
+
+    void reset() noexcept {
+        if (list_) {
+            list_allocator alloc(alloc_);
+            list_alloc_traits::destroy(alloc, list_);
+            list_alloc_traits::deallocate(alloc, std::exchange(list_, nullptr), 1);
+        }
+        std::destroy(items(), items() + count_);
+        count_ = 0;
+    }
+
+    [[no_unique_address]] Compare comp_;
+    [[no_unique_address]] Allocator alloc_;
+    size_type count_ = 0;
+    // The jump_list after promotion, allocated through Allocator; the
+    // inline array is unused while it exists.
+    list_type* list_ = nullptr;
+    alignas(T) unsigned char storage_[N * sizeof(T)];
+};
+
+#endif // SMALL_JUMP_LIST_H
@@ -3,9 +3,2308 @@
 
 #include <gtest/gtest.h>
 #include "jump_list.h"
+#include "jump_list_async.h"
+#include "buffered_jump_list.h"
+#include "concurrent_jump_list.h"
+#include "epoch_reclamation.h"
+#include "jump_list_map.h"
+#include "jump_list_parallel.h"
+#include "sharded_jump_list.h"
+#include "small_jump_list.h"
+#if __has_include(<sys/mman.h>)
+#include "mapped_jump_list.h"
+#endif
 
-TEST(jump_list, Example) {
-    EXPECT_EQ(1, 1);
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <ranges>
+#include <set>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+// Allocator that records every call so tests can check how the node pool
+// talks to it.
+struct allocation_log {
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+    std::size_t live() const { return allocations - deallocations; }
+};
+
+template<typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    allocation_log* log;
+
+    explicit counting_allocator(allocation_log* l) noexcept : log(l) {}
+
+    template<typename U>
+    counting_allocator(const counting_allocator<U>& other) noexcept : log(other.log) {}
+
+    T* allocate(std::size_t n) {
+        ++log->allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        ++log->deallocations;
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const counting_allocator<U>& other) const noexcept { return log == other.log; }
+};
+
+// Value whose copy constructor throws on demand.
+struct fragile {
+    static inline int copies_left = -1;
+
+    int key;
+
+    explicit fragile(int k) : key(k) {}
+    fragile(const fragile& other) : key(other.key) {
+        if (copies_left == 0) {
+            throw std::runtime_error("copy failed");
+        }
+        if (copies_left > 0) {
+            --copies_left;
+        }
+    }
+
+    bool operator<(const fragile& other) const { return key < other.key; }
+};
+
+template<typename List>
+std::vector<typename List::value_type> to_vector(const List& list) {
+    return {list.begin(), list.end()};
+}
+
+template<typename T, typename Compare = std::less<T>>
+using fat_list = jump_list<T, Compare, std::allocator<T>, fat_node_traits<16>>;
+
+template<typename T, typename Compare = std::less<T>>
+using compact_list = jump_list<T, Compare, std::allocator<T>, compact_traits>;
+
+template<typename Levels>
+struct level_traits : jump_list_traits {
+    using level_policy = Levels;
+};
+
+// Comparator the vector kernels cannot handle, with large classes of
+// equivalent keys.
+struct by_low_byte {
+    bool operator()(int a, int b) const { return (a & 0xff) < (b & 0xff); }
+};
+
+// Runs a list and a std::multiset through the same random inserts and
+// erasures and checks that contents and lookups agree.
+template<typename List, typename Gen>
+void expect_matches_multiset(Gen gen) {
+    using T = typename List::value_type;
+    List jl;
+    std::multiset<T, typename List::key_compare> ref;
+    std::minstd_rand rng(17);
+    for (int i = 0; i < 6000; ++i) {
+        T v = gen(rng);
+        if (rng() % 3 != 0) {
+            jl.insert(v);
+            ref.insert(v);
+        } else {
+            EXPECT_EQ(jl.erase(v), ref.erase(v));
+        }
+    }
+    ASSERT_EQ(jl.size(), ref.size());
+    EXPECT_TRUE(std::equal(jl.begin(), jl.end(), ref.begin(), ref.end()));
+    EXPECT_TRUE(std::equal(jl.rbegin(), jl.rend(), ref.rbegin(), ref.rend()));
+    for (int i = 0; i < 200; ++i) {
+        T v = gen(rng);
+        EXPECT_EQ(std::distance(jl.begin(), jl.lower_bound(v)), std::distance(ref.begin(), ref.lower_bound(v)));
+        EXPECT_EQ(std::distance(jl.begin(), jl.upper_bound(v)), std::distance(ref.begin(), ref.upper_bound(v)));
+        EXPECT_EQ(jl.count(v), ref.count(v));
+        EXPECT_EQ(jl.contains(v), ref.contains(v));
+    }
+    auto it = jl.begin();
+    auto rit = ref.begin();
+    while (it != jl.end()) {
+        it = jl.erase(it);
+        rit = ref.erase(rit);
+        if (it != jl.end()) {
+            ++it;
+            ++rit;
+        }
+    }
+    EXPECT_TRUE(std::equal(jl.begin(), jl.end(), ref.begin(), ref.end()));
+}
+
+} // namespace
+
+TEST(jump_list, ReadmeExample) {
+    jump_list<int> jl;
+    jl.insert({3, 1, 4, 1, 5});
+    EXPECT_EQ(to_vector(jl), (std::vector<int>{1, 1, 3, 4, 5}));
+    EXPECT_EQ(jl.size(), 5u);
+}
+
+TEST(jump_list, EmptyList) {
+    jump_list<int> jl;
+    EXPECT_TRUE(jl.empty());
+    EXPECT_EQ(jl.begin(), jl.end());
+    EXPECT_EQ(jl.find(1), jl.end());
+    EXPECT_EQ(jl.count(1), 0u);
+}
+
+TEST(jump_list, MatchesMultiset) {
+    jump_list<int> jl;
+    std::multiset<int> ref;
+    std::minstd_rand rng(7);
+    for (int i = 0; i < 5000; ++i) {
+        int v = static_cast<int>(rng() % 1000);
+        jl.insert(v);
+        ref.insert(v);
+    }
+    for (int i = 0; i < 2000; ++i) {
+        int v = static_cast<int>(rng() % 1000);
+        EXPECT_EQ(jl.erase(v), ref.erase(v));
+    }
+    EXPECT_EQ(jl.size(), ref.size());
+    EXPECT_TRUE(std::equal(jl.begin(), jl.end(), ref.begin(), ref.end()));
+    EXPECT_TRUE(std::equal(jl.rbegin(), jl.rend(), ref.rbegin(), ref.rend()));
+}
+
+TEST(jump_list, Lookup) {
+    jump_list<int> jl{5, 1, 3, 3, 3, 9};
+    EXPECT_EQ(*jl.find(3), 3);
+    EXPECT_EQ(jl.find(4), jl.end());
+    EXPECT_TRUE(jl.contains(9));
+    EXPECT_FALSE(jl.contains(0));
+    EXPECT_EQ(jl.count(3), 3u);
+    EXPECT_EQ(*jl.lower_bound(4), 5);
+    EXPECT_EQ(*jl.upper_bound(3), 5);
+    auto [first, last] = jl.equal_range(3);
+    EXPECT_EQ(std::distance(first, last), 3);
+    EXPECT_EQ(jl.upper_bound(9), jl.end());
+}
+
+// Ordered by id; counts how many are built so tests can tell whether a
+// lookup made a temporary.
+struct tracked {
+    static inline int constructed = 0;
+
+    int id;
+
+    explicit tracked(int i) : id(i) { ++constructed; }
+    tracked(const tracked& other) : id(other.id) { ++constructed; }
+};
+
+struct tracked_less {
+    using is_transparent = void;
+
+    bool operator()(const tracked& a, const tracked& b) const { return a.id < b.id; }
+    bool operator()(const tracked& a, int b) const { return a.id < b; }
+    bool operator()(int a, const tracked& b) const { return a < b.id; }
+};
+
+template<typename List, typename K>
+concept can_find = requires(const List& list, const K& key) { list.find(key); };
+
+TEST(jump_list, HeterogeneousLookup) {
+    jump_list<std::string, std::less<>> words{"pear", "apple", "fig", "fig", "plum"};
+    std::string_view fig = "fig";
+    EXPECT_EQ(*words.find(fig), "fig");
+    EXPECT_EQ(words.count(fig), 2u);
+    EXPECT_TRUE(words.contains("plum"));
+    EXPECT_FALSE(words.contains(std::string_view("kiwi")));
+    EXPECT_EQ(*words.lower_bound("b"), "fig");
+    EXPECT_EQ(*words.upper_bound(fig), "pear");
+    auto [first, last] = words.equal_range(fig);
+    EXPECT_EQ(std::distance(first, last), 2);
+    EXPECT_EQ(words.find("zzz"), words.end());
+
+    // Without is_transparent the probe must convert to the element type.
+    static_assert(!can_find<jump_list<std::string>, std::string_view>);
+    static_assert(can_find<jump_list<std::string>, const char*>);
+
+    jump_list<tracked, tracked_less> tl;
+    for (int i = 0; i < 100; i += 2) {
+        tl.insert(tracked(i));
+    }
+    int before = tracked::constructed;
+    EXPECT_EQ(tl.find(42)->id, 42);
+    EXPECT_EQ(tl.find(43), tl.end());
+    EXPECT_EQ(tl.count(10), 1u);
+    EXPECT_EQ(tl.lower_bound(11)->id, 12);
+    EXPECT_EQ(tl.upper_bound(98), tl.end());
+    EXPECT_EQ(tracked::constructed, before);
+
+    // Fat nodes take the scalar in-node search for foreign probe types, so
+    // 2.5 is not truncated to 2.
+    fat_list<std::int64_t, std::less<>> fl;
+    for (std::int64_t i = 0; i < 200; ++i) {
+        fl.insert(i);
+    }
+    EXPECT_EQ(*fl.lower_bound(2.5), 3);
+    EXPECT_EQ(*fl.upper_bound(2.0), 3);
+    EXPECT_EQ(fl.find(2.5), fl.end());
+    EXPECT_EQ(*fl.find(150.0), 150);
+    EXPECT_EQ(fl.count(7.0), 1u);
+    EXPECT_TRUE(fl.contains(199.0));
+}
+
+TEST(jump_list, EquivalentKeysKeepInsertionOrder) {
+    struct by_first {
+        bool operator()(const std::pair<int, int>& a, const std::pair<int, int>& b) const {
+            return a.first < b.first;
+        }
+    };
+    jump_list<std::pair<int, int>, by_first> jl;
+    for (int i = 0; i < 10; ++i) {
+        jl.insert({i % 2, i});
+    }
+    int last = -1;
+    for (auto it = jl.lower_bound({1, 0}); it != jl.end(); ++it) {
+        EXPECT_GT(it->second, last);
+        last = it->second;
+    }
+}
+
+TEST(jump_list, EraseByIterator) {
+    jump_list<int> jl{1, 2, 3, 4, 5};
+    auto it = jl.erase(jl.find(3));
+    EXPECT_EQ(*it, 4);
+    it = jl.erase(jl.begin(), jl.find(4));
+    EXPECT_EQ(it, jl.begin());
+    EXPECT_EQ(to_vector(jl), (std::vector<int>{4, 5}));
+    EXPECT_EQ(*std::prev(jl.end()), 5);
+}
+
+TEST(jump_list, CopyMoveSwap) {
+    jump_list<std::string> a{"pear", "apple", "plum"};
+    jump_list<std::string> b = a;
+    EXPECT_EQ(a, b);
+
+    jump_list<std::string> c = std::move(b);
+    EXPECT_TRUE(b.empty());
+    EXPECT_EQ(c, a);
+    c.insert("fig");
+    EXPECT_EQ(c.size(), 4u);
+    EXPECT_EQ(*std::prev(c.end()), "plum");
+
+    jump_list<std::string> d{"kiwi"};
+    swap(c, d);
+    EXPECT_EQ(to_vector(c), (std::vector<std::string>{"kiwi"}));
+    EXPECT_EQ(to_vector(d), (std::vector<std::string>{"apple", "fig", "pear", "plum"}));
+    d.erase("fig");
+    EXPECT_EQ(d, a);
+
+    b = d;
+    a = std::move(d);
+    EXPECT_EQ(a, b);
+    a = {"x", "y"};
+    EXPECT_EQ(a.size(), 2u);
+}
+
+TEST(jump_list, Comparison) {
+    jump_list<int> a{1, 2, 3};
+    jump_list<int> b{1, 2, 4};
+    jump_list<int> c{1, 2};
+    EXPECT_LT(a, b);
+    EXPECT_GT(a, c);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(a <=> (jump_list<int>{3, 2, 1}), std::strong_ordering::equal);
+}
+
+TEST(jump_list, FatComparisonAcrossNodeBoundaries) {
+    std::vector<std::int64_t> data(5000);
+    std::minstd_rand rng(12);
+    for (auto& v : data) {
+        v = static_cast<std::int64_t>(rng() % 3000) - 1500;
+    }
+    // Random inserts leave nodes part full, the sorted build packs them, so
+    // the two lists split the same elements at different places.
+    fat_list<std::int64_t> scattered(data.begin(), data.end());
+    std::sort(data.begin(), data.end());
+    fat_list<std::int64_t> packed(sorted_equivalent, data.begin(), data.end());
+    EXPECT_EQ(scattered, packed);
+    EXPECT_EQ(scattered <=> packed, std::strong_ordering::equal);
+    for (int i = 0; i < 50; ++i) {
+        std::vector<std::int64_t> changed = data;
+        changed[rng() % changed.size()] += rng() % 2 == 0 ? 1 : -1;
+        if (rng() % 4 == 0) {
+            changed.resize(rng() % changed.size());
+        }
+        std::sort(changed.begin(), changed.end());
+        fat_list<std::int64_t> other(sorted_equivalent, changed.begin(), changed.end());
+        EXPECT_EQ(scattered == other, data == changed);
+        EXPECT_EQ(scattered <=> other, data <=> changed);
+        EXPECT_EQ(other <=> scattered, changed <=> data);
+    }
+    EXPECT_NE(fat_list<double>({0.0}), fat_list<double>({1.0}));
+    EXPECT_EQ(fat_list<double>({0.0}), fat_list<double>({-0.0}));
+}
+
+// Checks the set operations of two lists against the std algorithms on
+// the same elements.
+template<typename List>
+void expect_set_operations(const std::vector<int>& x, const std::vector<int>& y) {
+    List a(x.begin(), x.end());
+    List b(y.begin(), y.end());
+    std::vector<int> sx = to_vector(a);
+    std::vector<int> sy = to_vector(b);
+    std::vector<int> expected;
+    std::set_union(sx.begin(), sx.end(), sy.begin(), sy.end(), std::back_inserter(expected), a.key_comp());
+    EXPECT_EQ(to_vector(set_union(a, b)), expected);
+    expected.clear();
+    std::set_intersection(sx.begin(), sx.end(), sy.begin(), sy.end(), std::back_inserter(expected), a.key_comp());
+    EXPECT_EQ(to_vector(set_intersection(a, b)), expected);
+    expected.clear();
+    std::set_difference(sx.begin(), sx.end(), sy.begin(), sy.end(), std::back_inserter(expected), a.key_comp());
+    List difference = set_difference(a, b);
+    EXPECT_EQ(to_vector(difference), expected);
+    EXPECT_EQ(difference.size(), expected.size());
+    for (int v : expected) {
+        EXPECT_TRUE(difference.contains(v));
+    }
+}
+
+TEST(jump_list, SetOperationsMatchStd) {
+    std::minstd_rand rng(13);
+    auto draw = [&](std::size_t n, int range) {
+        std::vector<int> v(n);
+        for (auto& e : v) {
+            e = static_cast<int>(rng() % static_cast<unsigned>(range));
+        }
+        return v;
+    };
+    for (auto [m, n] : {std::pair<std::size_t, std::size_t>{0, 0}, {0, 100}, {30, 5000}, {3000, 4000}, {5000, 7}}) {
+        auto x = draw(m, 2000);
+        auto y = draw(n, 2000);
+        expect_set_operations<jump_list<int>>(x, y);
+        expect_set_operations<jump_list<int>>(y, x);
+        expect_set_operations<jump_list<int, by_low_byte>>(x, y);
+        expect_set_operations<jump_list<int, std::less<int>, std::allocator<int>, indexable_traits>>(x, y);
+        expect_set_operations<jump_list<int, std::less<int>, std::allocator<int>, forward_only_traits>>(x, y);
+    }
+    jump_list<int, std::less<int>, std::allocator<int>, indexable_traits> a{1, 3, 3, 5, 7};
+    jump_list<int, std::less<int>, std::allocator<int>, indexable_traits> b{3, 4, 5};
+    auto u = set_union(a, b);
+    EXPECT_EQ(*u.nth(3), 4);
+    EXPECT_EQ(u.rank(5), 4u);
+}
+
+TEST(jump_list, PoolAllocatesInSlabs) {
+    allocation_log log;
+    {
+        jump_list<int, std::less<int>, counting_allocator<int>> jl{counting_allocator<int>(&log)};
+        for (int i = 0; i < 10000; ++i) {
+            jl.insert(i);
+        }
+        EXPECT_LT(log.allocations, 200u);
+
+        // Freed nodes are reused before the pool asks for more memory; only
+        // a tower height that was never drawn before may need a new slab.
+        std::size_t before = log.allocations;
+        for (int i = 0; i < 10000; ++i) {
+            jl.erase(jl.begin());
+            jl.insert(i);
+        }
+        EXPECT_LT(log.allocations - before, 8u);
+
+        jl.clear();
+        EXPECT_EQ(log.live(), 0u);
+        jl.insert(1);
+        EXPECT_EQ(*jl.begin(), 1);
+    }
+    EXPECT_EQ(log.live(), 0u);
+}
+
+TEST(jump_list, AllocatorAwareMove) {
+    allocation_log log1;
+    allocation_log log2;
+    using list = jump_list<int, std::less<int>, counting_allocator<int>>;
+    list a({1, 2, 3}, counting_allocator<int>(&log1));
+    list b(std::move(a), counting_allocator<int>(&log2));
+    EXPECT_EQ(to_vector(b), (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(log1.live(), 0u);
+    EXPECT_GT(log2.live(), 0u);
+    EXPECT_EQ(b.get_allocator().log, &log2);
+}
+
+TEST(jump_list, InsertIsStronglyExceptionSafe) {
+    jump_list<fragile> jl;
+    for (int i = 0; i < 100; ++i) {
+        jl.insert(fragile(i));
+    }
+    fragile::copies_left = 0;
+    fragile extra(50);
+    EXPECT_THROW(jl.insert(extra), std::runtime_error);
+    fragile::copies_left = -1;
+    EXPECT_EQ(jl.size(), 100u);
+    int expected = 0;
+    for (const auto& f : jl) {
+        EXPECT_EQ(f.key, expected++);
+    }
+}
+
+TEST(jump_list, CopyAssignmentIsStronglyExceptionSafe) {
+    jump_list<fragile> a;
+    jump_list<fragile> b;
+    for (int i = 0; i < 10; ++i) {
+        a.insert(fragile(i));
+        b.insert(fragile(i + 100));
+    }
+    fragile::copies_left = 5;
+    EXPECT_THROW(b = a, std::runtime_error);
+    fragile::copies_left = -1;
+    EXPECT_EQ(b.size(), 10u);
+    EXPECT_EQ(b.begin()->key, 100);
+}
+
+TEST(jump_list, CopyClonesStructure) {
+    allocation_log log;
+    using list = jump_list<int, std::less<int>, counting_allocator<int>>;
+    std::minstd_rand rng(7);
+    list a{counting_allocator<int>(&log)};
+    for (int i = 0; i < 10000; ++i) {
+        a.insert(static_cast<int>(rng() % 5000));
+    }
+
+    // One slab per tower height, and the same towers as the original: the
+    // partition cuts fall on the same elements.
+    std::size_t before = log.allocations;
+    list b(a);
+    EXPECT_LE(log.allocations - before, 20u);
+    EXPECT_EQ(a, b);
+    auto pa = a.partition(16);
+    auto pb = b.partition(16);
+    ASSERT_EQ(pa.size(), pb.size());
+    for (std::size_t i = 0; i < pa.size(); ++i) {
+        EXPECT_EQ(std::ranges::distance(pa[i]), std::ranges::distance(pb[i]));
+    }
+
+    // Assigning over a list with the same towers only recycles its nodes.
+    b.erase(b.begin(), std::next(b.begin(), 100));
+    b.insert(-1);
+    before = log.allocations;
+    b = a;
+    EXPECT_EQ(log.allocations, before);
+    EXPECT_EQ(a, b);
+
+    list c{counting_allocator<int>(&log)};
+    c.insert(1);
+    c = a;
+    EXPECT_EQ(a, c);
+    c = list{counting_allocator<int>(&log)};
+    EXPECT_TRUE(c.empty());
+}
+
+TEST(jump_list, StatsCountOperations) {
+    jump_list<int, std::less<int>, std::allocator<int>, stats_traits> jl;
+    for (int i = 0; i < 1000; ++i) {
+        jl.insert((i * 7919) % 1000);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(jl.contains(i));
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        jl.erase(jl.find(i));
+    }
+
+    jump_list_stats s = jl.stats();
+    EXPECT_EQ(s.node_allocations, 1000u);
+    EXPECT_EQ(s.node_frees, 500u);
+    EXPECT_EQ(std::accumulate(s.heights.begin(), s.heights.end(), std::uint64_t{0}), 500u);
+    EXPECT_GT(s.heights[0], s.heights[1]);
+    // One descent per insert, lookup and erasure of a single element.
+    EXPECT_EQ(s.searches, 3000u);
+    EXPECT_GT(s.comparisons_per_search(), 1.0);
+    EXPECT_GT(s.hops[0], 0u);
+    for (const auto* h : {&s.insert, &s.find, &s.erase}) {
+        EXPECT_GT(h->samples, 0u);
+        EXPECT_EQ(std::accumulate(h->buckets.begin(), h->buckets.end(), std::uint64_t{0}), h->samples);
+    }
+    EXPECT_EQ(s.insert.samples, 1000u / 64 + 1);
+
+    jl.clear();
+    EXPECT_EQ(jl.stats().node_frees, 1000u);
+    jl.reset_stats();
+    EXPECT_EQ(jl.stats().searches, 0u);
+    EXPECT_EQ(jl.stats().find.samples, 0u);
+}
+
+TEST(jump_list, SortedConstructor) {
+    std::vector<int> src(1000);
+    for (int i = 0; i < 1000; ++i) {
+        src[i] = i / 3;
+    }
+    jump_list<int> jl(sorted_equivalent, src.begin(), src.end());
+    EXPECT_EQ(jl.size(), src.size());
+    EXPECT_EQ(to_vector(jl), src);
+    EXPECT_EQ(jl.count(10), 3u);
+    EXPECT_EQ(*jl.lower_bound(200), 200);
+    EXPECT_EQ(jl.lower_bound(500), jl.end());
+    jl.erase(jl.find(100));
+    jl.insert(-1);
+    EXPECT_EQ(*jl.begin(), -1);
+    EXPECT_EQ(jl.size(), src.size());
+}
+
+TEST(jump_list, SortedConstructorFromInputIterator) {
+    std::istringstream in("1 2 2 3 5 8");
+    jump_list<int> jl(sorted_equivalent, std::istream_iterator<int>(in), std::istream_iterator<int>());
+    EXPECT_EQ(to_vector(jl), (std::vector<int>{1, 2, 2, 3, 5, 8}));
+    EXPECT_EQ(*std::prev(jl.end()), 8);
+}
+
+TEST(jump_list, InsertSortedAppendsAndMerges) {
+    jump_list<int> jl{10, 20, 30};
+    jl.insert_sorted(std::views::iota(30, 40));
+    jl.insert_sorted(std::vector<int>{0, 5, 15, 20, 25, 45});
+    std::multiset<int> ref{10, 20, 30, 0, 5, 15, 20, 25, 45};
+    for (int i = 30; i < 40; ++i) {
+        ref.insert(i);
+    }
+    EXPECT_TRUE(std::equal(jl.begin(), jl.end(), ref.begin(), ref.end()));
+    EXPECT_TRUE(std::equal(jl.rbegin(), jl.rend(), ref.rbegin(), ref.rend()));
+    for (int v : ref) {
+        EXPECT_TRUE(jl.contains(v));
+    }
+    EXPECT_EQ(jl.count(20), 2u);
+}
+
+TEST(jump_list, InsertSortedPlacesNewEquivalentsLast) {
+    struct by_first {
+        bool operator()(const std::pair<int, int>& a, const std::pair<int, int>& b) const {
+            return a.first < b.first;
+        }
+    };
+    jump_list<std::pair<int, int>, by_first> jl{{1, 0}, {2, 0}, {3, 0}};
+    jl.insert_sorted(std::list<std::pair<int, int>>{{1, 1}, {2, 1}, {2, 2}});
+    std::vector<std::pair<int, int>> expected{{1, 0}, {1, 1}, {2, 0}, {2, 1}, {2, 2}, {3, 0}};
+    EXPECT_EQ(to_vector(jl), expected);
+}
+
+TEST(jump_list, SortedInputTakesBulkPath) {
+    std::vector<int> big(100000);
+    std::iota(big.begin(), big.end(), 0);
+    jump_list<int> jl(big.begin(), big.end());
+    EXPECT_EQ(jl.size(), big.size());
+    EXPECT_TRUE(std::equal(jl.begin(), jl.end(), big.begin(), big.end()));
+    for (int i = 0; i < 100000; i += 997) {
+        EXPECT_EQ(*jl.find(i), i);
+    }
+}
+
+TEST(jump_list, HintedInsert) {
+    // With the finger on, runs of inserts at one hint reuse it.
+    for (bool finger : {false, true}) {
+        jump_list<int> jl;
+        jl.finger_search(finger);
+        std::multiset<int> ref;
+        for (int i = 0; i < 1000; ++i) {
+            jl.insert(jl.end(), i);
+            ref.insert(ref.end(), i);
+        }
+        // Valid hints, hints that are off by a lot, and duplicates.
+        std::minstd_rand rng(3);
+        for (int i = 0; i < 2000; ++i) {
+            int v = static_cast<int>(rng() % 1200);
+            auto hint = rng() % 2 ? jl.lower_bound(v) : jl.begin();
+            auto it = jl.insert(hint, v);
+            EXPECT_EQ(*it, v);
+            ref.insert(v);
+            if (i % 100 == 0) {
+                for (int k = 0; k < 5; ++k) {
+                    it = jl.insert(it, v);
+                    ref.insert(v);
+                }
+            }
+        }
+        EXPECT_TRUE(std::equal(jl.begin(), jl.end(), ref.begin(), ref.end()));
+        EXPECT_TRUE(std::equal(jl.rbegin(), jl.rend(), ref.rbegin(), ref.rend()));
+        for (int v = 0; v < 1200; ++v) {
+            EXPECT_EQ(jl.count(v), ref.count(v));
+        }
+    }
+}
+
+TEST(jump_list, HintedInsertPlacesBeforeHint) {
+    struct by_first {
+        bool operator()(const std::pair<int, int>& a, const std::pair<int, int>& b) const {
+            return a.first < b.first;
+        }
+    };
+    jump_list<std::pair<int, int>, by_first> jl{{1, 0}, {1, 1}, {1, 2}};
+    auto it = jl.insert(std::next(jl.begin()), {1, 9});
+    EXPECT_EQ(std::distance(jl.begin(), it), 1);
+    EXPECT_EQ(std::next(jl.begin())->second, 9);
+}
+
+TEST(jump_list, FingerSearchMatchesMultiset) {
+    jump_list<int> jl;
+    jl.finger_search(true);
+    EXPECT_TRUE(jl.finger_search());
+    std::multiset<int> ref;
+    std::minstd_rand rng(11);
+    int cursor = 0;
+    for (int i = 0; i < 20000; ++i) {
+        // Mostly increasing keys with occasional jumps back.
+        cursor += static_cast<int>(rng() % 5) - (rng() % 50 == 0 ? 200 : 1);
+        switch (rng() % 4) {
+        case 0:
+        case 1:
+            jl.insert(cursor);
+            ref.insert(cursor);
+            break;
+        case 2:
+            EXPECT_EQ(jl.contains(cursor), ref.count(cursor) != 0);
+            EXPECT_EQ(jl.lower_bound(cursor) == jl.end(), ref.lower_bound(cursor) == ref.end());
+            break;
+        default: {
+            auto it = jl.find(cursor);
+            if (it != jl.end()) {
+                jl.erase(it);
+                ref.erase(ref.find(cursor));
+            }
+        }
+        }
+    }
+    EXPECT_EQ(jl.size(), ref.size());
+    EXPECT_TRUE(std::equal(jl.begin(), jl.end(), ref.begin(), ref.end()));
+
+    jump_list<int> copy = jl;
+    EXPECT_TRUE(copy.finger_search());
+    jl.clear();
+    jl.insert(5);
+    EXPECT_TRUE(jl.contains(5));
+    EXPECT_EQ(copy.size(), ref.size());
+    EXPECT_EQ(copy.upper_bound(*ref.rbegin()), copy.end());
+}
+
+TEST(jump_list, FindBatchMatchesFind) {
+    jump_list<int> jl;
+    std::minstd_rand rng(13);
+    for (int i = 0; i < 5000; ++i) {
+        jl.insert(static_cast<int>(rng() % 8000));
+    }
+    for (std::size_t m : {0u, 1u, 7u, 16u, 1000u}) {
+        std::vector<int> keys(m);
+        for (auto& k : keys) {
+            k = static_cast<int>(rng() % 8200) - 100;
+        }
+        std::vector<jump_list<int>::iterator> found(m);
+        std::unique_ptr<bool[]> hit(new bool[m]);
+        jl.find_batch(keys, found);
+        jl.contains_batch(keys, std::span<bool>(hit.get(), m));
+        for (std::size_t i = 0; i < m; ++i) {
+            EXPECT_EQ(found[i], jl.find(keys[i]));
+            EXPECT_EQ(hit[i], jl.contains(keys[i]));
+        }
+        std::sort(keys.begin(), keys.end());
+        jl.find_batch(keys, found);
+        for (std::size_t i = 0; i < m; ++i) {
+            EXPECT_EQ(found[i], jl.find(keys[i]));
+        }
+    }
+
+    jump_list<int, std::greater<int>> desc{5, 3, 3, 1};
+    std::vector<int> keys{3, 4, 1, 5, 0};
+    std::vector<jump_list<int, std::greater<int>>::iterator> found(keys.size());
+    desc.find_batch(keys, found);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_EQ(found[i], desc.find(keys[i]));
+    }
+    jump_list<int> empty;
+    std::vector<jump_list<int>::iterator> none(keys.size(), jl.begin());
+    empty.find_batch(keys, none);
+    EXPECT_TRUE(std::all_of(none.begin(), none.end(), [&](auto it) { return it == empty.end(); }));
+}
+
+TEST(jump_list, FindAsyncMatchesFind) {
+    jump_list<int> jl;
+    std::minstd_rand rng(31);
+    for (int i = 0; i < 5000; ++i) {
+        jl.insert(static_cast<int>(rng() % 20000));
+    }
+    std::vector<int> keys(3000);
+    for (int& k : keys) {
+        k = static_cast<int>(rng() % 20001) - 1;
+    }
+    for (int k : {keys[0], -1, 20000}) {
+        auto lookup = jl.find_async(k);
+        EXPECT_FALSE(lookup.done());
+        EXPECT_EQ(lookup.get(), jl.find(k));
+        EXPECT_TRUE(lookup.done());
+    }
+
+    std::vector<jump_list<int>::const_iterator> found(keys.size());
+    std::size_t calls = 0;
+    auto record = [&](std::size_t i, jump_list<int>::const_iterator it) {
+        found[i] = it;
+        ++calls;
+    };
+    lookup_scheduler<jump_list<int>, decltype(record)> scheduler(jl, record, 16);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        scheduler.submit(keys[i], i);
+        EXPECT_LE(scheduler.in_flight(), 16u);
+    }
+    while (scheduler.poll() != 0) {
+    }
+    EXPECT_EQ(calls, keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_EQ(found[i], jl.find(keys[i]));
+    }
+
+    jump_list<std::string, std::less<>> names{"ada", "bob", "eve"};
+    EXPECT_EQ(*names.find_async(std::string_view("bob")).get(), "bob");
+    EXPECT_EQ(names.find_async(std::string_view("zed")).get(), names.end());
+}
+
+TEST(jump_list, FindAsyncRethrowsComparatorErrors) {
+    struct picky {
+        bool operator()(int a, int b) const {
+            if (a == 13 || b == 13) {
+                throw std::runtime_error("unlucky");
+            }
+            return a < b;
+        }
+    };
+    jump_list<int, picky> jl;
+    for (int i = 0; i < 100; i += 2) {
+        jl.insert(i);
+    }
+    EXPECT_THROW(jl.find_async(13).get(), std::runtime_error);
+    std::vector<std::size_t> done;
+    auto record = [&](std::size_t tag, jump_list<int, picky>::const_iterator) { done.push_back(tag); };
+    lookup_scheduler<jump_list<int, picky>, decltype(record)> scheduler(jl, record);
+    scheduler.submit(4, 0);
+    scheduler.submit(13, 1);
+    scheduler.submit(50, 2);
+    EXPECT_THROW(scheduler.drain(), std::runtime_error);
+    scheduler.drain();
+    std::ranges::sort(done);
+    EXPECT_EQ(done, (std::vector<std::size_t>{0, 2}));
+}
+
+TEST(jump_list, FatNodesMatchMultiset) {
+    expect_matches_multiset<fat_list<int>>([](auto& rng) { return static_cast<int>(rng() % 500) - 250; });
+    expect_matches_multiset<fat_list<std::int64_t>>(
+        [](auto& rng) { return (static_cast<std::int64_t>(rng() % 4000) - 2000) << 40; });
+    expect_matches_multiset<fat_list<std::uint32_t>>(
+        [](auto& rng) { return static_cast<std::uint32_t>(rng() % 600) - 300u; });
+    expect_matches_multiset<fat_list<std::uint64_t>>(
+        [](auto& rng) { return static_cast<std::uint64_t>(rng() % 600) - 300u; });
+    expect_matches_multiset<fat_list<float>>([](auto& rng) { return static_cast<float>(rng() % 900) / 8 - 50; });
+    expect_matches_multiset<fat_list<double, std::greater<>>>(
+        [](auto& rng) { return static_cast<double>(rng() % 900) / 4 - 100; });
+    expect_matches_multiset<fat_list<int, by_low_byte>>([](auto& rng) { return static_cast<int>(rng() % 4000); });
+    expect_matches_multiset<jump_list<long, std::less<long>, std::allocator<long>, fat_node_traits<64>>>(
+        [](auto& rng) { return static_cast<long>(rng() % 3000); });
+}
+
+TEST(jump_list, FatNodesConstructCopyAndCompare) {
+    std::vector<int> data(10000);
+    std::iota(data.begin(), data.end(), 0);
+    fat_list<int> sorted(sorted_equivalent, data.begin(), data.end());
+    EXPECT_EQ(sorted.size(), data.size());
+    EXPECT_EQ(to_vector(sorted), data);
+    EXPECT_EQ(*sorted.lower_bound(4321), 4321);
+    EXPECT_EQ(sorted.upper_bound(9999), sorted.end());
+    EXPECT_EQ(sorted.find(10000), sorted.end());
+
+    fat_list<int> copy = sorted;
+    EXPECT_EQ(copy, sorted);
+    copy.insert(-1);
+    EXPECT_LT(copy, sorted);
+    fat_list<int> moved = std::move(copy);
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(moved.size(), data.size() + 1);
+    copy = {3, 1, 2};
+    swap(copy, moved);
+    EXPECT_EQ(to_vector(moved), (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(*copy.begin(), -1);
+    auto rest = copy.erase(copy.begin(), copy.find(5000));
+    EXPECT_EQ(rest, copy.begin());
+    EXPECT_EQ(*rest, 5000);
+    EXPECT_EQ(copy.size(), 5000u);
+    copy.clear();
+    EXPECT_EQ(copy.begin(), copy.end());
+    copy.insert(7);
+    EXPECT_EQ(*--copy.end(), 7);
+}
+
+TEST(jump_list, CompactLinksMatchMultiset) {
+    expect_matches_multiset<compact_list<int>>([](auto& rng) { return static_cast<int>(rng() % 500) - 250; });
+    expect_matches_multiset<compact_list<std::int64_t>>(
+        [](auto& rng) { return (static_cast<std::int64_t>(rng() % 4000) - 2000) << 40; });
+    expect_matches_multiset<compact_list<double, std::greater<>>>(
+        [](auto& rng) { return static_cast<double>(rng() % 900) / 4 - 100; });
+    expect_matches_multiset<compact_list<int, by_low_byte>>([](auto& rng) { return static_cast<int>(rng() % 4000); });
+}
+
+TEST(jump_list, CompactLinksSurviveArenaGrowth) {
+    std::vector<int> data(10000);
+    std::iota(data.begin(), data.end(), 0);
+    compact_list<int> sorted(sorted_equivalent, data.begin(), data.end());
+    EXPECT_EQ(to_vector(sorted), data);
+    EXPECT_EQ(*sorted.lower_bound(4321), 4321);
+    EXPECT_EQ(sorted.find(10000), sorted.end());
+
+    // Iterators hold offsets, so they outlive the arena's reallocations.
+    compact_list<int> list;
+    auto first = list.insert(5000);
+    std::minstd_rand rng(3);
+    for (int i = 0; i < 20000; ++i) {
+        list.insert(static_cast<int>(rng() % 10000));
+    }
+    EXPECT_EQ(*first, 5000);
+    EXPECT_EQ(list.find(5000), first);
+    std::size_t bytes = list.arena_bytes();
+    list.erase(list.begin(), list.lower_bound(5000));
+    for (int i = 0; i < 1000; ++i) {
+        list.insert(static_cast<int>(rng() % 5000));
+    }
+    EXPECT_EQ(list.arena_bytes(), bytes);
+    EXPECT_TRUE(std::is_sorted(list.begin(), list.end()));
+
+    compact_list<int> copy = list;
+    EXPECT_EQ(copy, list);
+    copy.insert(-1);
+    EXPECT_LT(copy, list);
+    compact_list<int> moved = std::move(copy);
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(copy.begin(), copy.end());
+    copy = {3, 1, 2};
+    swap(copy, moved);
+    EXPECT_EQ(to_vector(moved), (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(*copy.begin(), -1);
+}
+
+// Checks that the fraction of draws reaching each height follows p^(h - 1).
+template<typename Levels>
+void expect_geometric(double p) {
+    Levels levels;
+    constexpr int draws = 200000;
+    std::vector<int> at_least(8, 0);
+    for (int i = 0; i < draws; ++i) {
+        int h = levels(6);
+        ASSERT_GE(h, 1);
+        ASSERT_LE(h, 6);
+        for (int j = 1; j <= h; ++j) {
+            ++at_least[j];
+        }
+    }
+    for (int h = 2; h <= 4; ++h) {
+        EXPECT_NEAR(static_cast<double>(at_least[h]) / draws, std::pow(p, h - 1), 0.01) << "height " << h;
+    }
+    EXPECT_EQ(at_least[7], 0);
+}
+
+TEST(jump_list, LevelPolicies) {
+    expect_geometric<geometric_levels<>>(0.5);
+    expect_geometric<geometric_levels<std::ratio<1, 4>>>(0.25);
+    expect_geometric<geometric_levels<inverse_e>>(0.36787944117144233);
+    expect_geometric<geometric_levels<std::ratio<2, 3>>>(2.0 / 3);
+
+    deterministic_levels<> a;
+    deterministic_levels<> b;
+    int differing = 0;
+    for (int i = 0; i < 1000; ++i) {
+        differing += a(32) != b(32);
+    }
+    EXPECT_EQ(differing, 0);
+    EXPECT_EQ(geometric_levels<>()(1), 1);
+
+    expect_matches_multiset<jump_list<int, std::less<int>, std::allocator<int>,
+                                      level_traits<geometric_levels<std::ratio<1, 4>>>>>(
+        [](auto& rng) { return static_cast<int>(rng() % 500); });
+    expect_matches_multiset<jump_list<int, std::less<int>, std::allocator<int>, level_traits<deterministic_levels<>>>>(
+        [](auto& rng) { return static_cast<int>(rng() % 500); });
+}
+
+// Checks every positional query of an indexable list against iteration.
+template<typename List>
+void expect_positions(const List& jl) {
+    std::size_t i = 0;
+    for (auto it = jl.begin(); it != jl.end(); ++it, ++i) {
+        ASSERT_EQ(jl.nth(i), it);
+        ASSERT_EQ(jl.index_of(it), i);
+        ASSERT_EQ(jl.rank(*it), static_cast<std::size_t>(std::distance(jl.begin(), jl.lower_bound(*it))));
+    }
+    EXPECT_EQ(i, jl.size());
+    EXPECT_EQ(jl.nth(jl.size()), jl.end());
+    EXPECT_EQ(jl.index_of(jl.end()), jl.size());
+}
+
+TEST(jump_list, IndexableMatchesIteration) {
+    using list = jump_list<int, by_low_byte, std::allocator<int>, indexable_traits>;
+    for (bool finger : {false, true}) {
+        list jl;
+        jl.finger_search(finger);
+        std::minstd_rand rng(23);
+        for (int round = 0; round < 40; ++round) {
+            for (int i = 0; i < 50; ++i) {
+                int v = static_cast<int>(rng() % 1000);
+                switch (rng() % 4) {
+                case 0:
+                    jl.insert(v);
+                    break;
+                case 1:
+                    jl.insert(jl.nth(rng() % (jl.size() + 1)), v);
+                    break;
+                case 2:
+                    jl.erase(v);
+                    break;
+                default:
+                    if (!jl.empty()) {
+                        jl.erase(jl.nth(rng() % jl.size()));
+                    }
+                }
+            }
+            if (round % 10 == 9) {
+                std::vector<int> sorted(100);
+                for (int& v : sorted) {
+                    v = static_cast<int>(rng() % 1000);
+                }
+                std::ranges::sort(sorted, by_low_byte());
+                jl.insert_sorted(sorted);
+            }
+            expect_positions(jl);
+        }
+        ASSERT_GT(jl.size(), 100u);
+        EXPECT_EQ(jl.advance(jl.begin(), 7), std::next(jl.begin(), 7));
+        EXPECT_EQ(jl.advance(jl.end(), -3), std::prev(jl.end(), 3));
+        EXPECT_EQ(jl.distance(jl.nth(5), jl.nth(60)), 55);
+        EXPECT_EQ(jl.distance(jl.end(), jl.begin()), -static_cast<std::ptrdiff_t>(jl.size()));
+        EXPECT_EQ(jl.rank(0x100), jl.index_of(jl.lower_bound(0)));
+
+        list copy = jl;
+        expect_positions(copy);
+        list moved = std::move(copy);
+        expect_positions(moved);
+        std::swap(moved, jl);
+        expect_positions(jl);
+        jl.clear();
+        jl.insert_sorted(std::vector<int>{1, 2, 3});
+        expect_positions(jl);
+    }
+}
+
+// Runs range erase, split and merge against std::multiset. Merged keys
+// share low bytes with the existing ones, so ties must keep this list's
+// elements first; mode picks disjoint or interleaved key ranges.
+template<typename List>
+void expect_splice_matches_multiset() {
+    using ref_set = std::multiset<int, by_low_byte>;
+    std::minstd_rand rng(5);
+    for (int round = 0; round < 60; ++round) {
+        List jl;
+        List other;
+        ref_set ref;
+        ref_set other_ref;
+        jl.finger_search(round % 2 == 0);
+        int mode = round % 3;
+        for (int i = 0; i < 200; ++i) {
+            int v = static_cast<int>(rng() % 1000);
+            int w = static_cast<int>(rng() % 1000);
+            if (mode != 0) {
+                v = (v & ~0xff) | static_cast<int>(rng() % 128);
+                w = (w & ~0xff) | static_cast<int>(rng() % 128 + (mode == 1 ? 128 : 0));
+            }
+            jl.insert(v);
+            ref.insert(v);
+            other.insert(w);
+            other_ref.insert(w);
+        }
+        if (round % 6 == 1) {
+            std::swap(jl, other);
+            std::swap(ref, other_ref);
+        }
+        jl.merge(std::move(other));
+        ref.merge(other_ref);
+        EXPECT_TRUE(other.empty());
+        ASSERT_EQ(to_vector(jl), std::vector<int>(ref.begin(), ref.end()));
+        EXPECT_TRUE(std::equal(jl.rbegin(), jl.rend(), ref.rbegin(), ref.rend()));
+
+        std::size_t i = rng() % jl.size();
+        std::size_t j = i + rng() % (jl.size() - i + 1);
+        auto it = jl.erase(std::next(jl.begin(), i), std::next(jl.begin(), j));
+        auto rit = ref.erase(std::next(ref.begin(), i), std::next(ref.begin(), j));
+        EXPECT_EQ(std::distance(jl.begin(), it), std::distance(ref.begin(), rit));
+        ASSERT_EQ(to_vector(jl), std::vector<int>(ref.begin(), ref.end()));
+
+        int key = static_cast<int>(rng() % 256);
+        List tail = jl.split(key);
+        ref_set ref_tail(ref.lower_bound(key), ref.end());
+        ref.erase(ref.lower_bound(key), ref.end());
+        ASSERT_EQ(to_vector(jl), std::vector<int>(ref.begin(), ref.end()));
+        ASSERT_EQ(to_vector(tail), std::vector<int>(ref_tail.begin(), ref_tail.end()));
+        for (int k = 0; k < 50; ++k) {
+            int v = static_cast<int>(rng() % 1000);
+            jl.insert(v);
+            ref.insert(v);
+            tail.erase(v);
+            ref_tail.erase(v);
+        }
+        EXPECT_TRUE(std::equal(jl.begin(), jl.end(), ref.begin(), ref.end()));
+        EXPECT_TRUE(std::equal(tail.rbegin(), tail.rend(), ref_tail.rbegin(), ref_tail.rend()));
+        if constexpr (requires { jl.nth(0); }) {
+            expect_positions(jl);
+            expect_positions(tail);
+        }
+    }
+}
+
+TEST(jump_list, InsertSortedShortRangeKeepsTowers) {
+    // A range much shorter than the list is linked by resumed searches; its
+    // towers must stay as tall as single inserts would make them, and the
+    // link widths right.
+    jump_list<int, std::less<int>, std::allocator<int>, indexable_traits> jl;
+    std::multiset<int> ref;
+    std::minstd_rand rng(8);
+    for (int round = 0; round < 200; ++round) {
+        std::vector<int> batch(64);
+        for (int& v : batch) {
+            v = static_cast<int>(rng() % 100000);
+        }
+        std::ranges::sort(batch);
+        jl.insert_sorted(batch);
+        ref.insert(batch.begin(), batch.end());
+    }
+    EXPECT_TRUE(std::ranges::equal(jl, ref));
+    expect_positions(jl);
+    EXPECT_GT(jl.height_profile().levels, 10);
+}
+
+TEST(jump_list, RangeEraseSplitMerge) {
+    expect_splice_matches_multiset<jump_list<int, by_low_byte>>();
+    expect_splice_matches_multiset<jump_list<int, by_low_byte, std::allocator<int>, indexable_traits>>();
+
+    // Merged nodes keep living in their slabs, which move to the target.
+    allocation_log log;
+    using list = jump_list<int, std::less<int>, counting_allocator<int>>;
+    list a({1, 3, 5}, std::less<int>(), counting_allocator<int>(&log));
+    {
+        list b({2, 4, 6}, std::less<int>(), counting_allocator<int>(&log));
+        std::size_t allocations = log.allocations;
+        a.merge(b);
+        EXPECT_EQ(log.allocations, allocations);
+    }
+    EXPECT_EQ(to_vector(a), (std::vector<int>{1, 2, 3, 4, 5, 6}));
+    allocation_log other_log;
+    list c({0, 7}, std::less<int>(), counting_allocator<int>(&other_log));
+    a.merge(c);
+    EXPECT_TRUE(c.empty());
+    EXPECT_EQ(to_vector(a), (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7}));
+    a.erase(a.begin(), a.end());
+    EXPECT_TRUE(a.empty());
+    a.clear();
+    EXPECT_EQ(log.live(), 0u);
+}
+
+TEST(jump_list, ForwardOnlyReverseIteration) {
+    using list = jump_list<int, by_low_byte, std::allocator<int>, forward_only_traits>;
+    static_assert(!std::bidirectional_iterator<list::iterator>);
+    static_assert(std::bidirectional_iterator<list::reverse_iterator>);
+    expect_matches_multiset<list>([](auto& rng) { return static_cast<int>(rng() % 4000); });
+    expect_splice_matches_multiset<list>();
+
+    std::vector<int> data(5000);
+    std::iota(data.begin(), data.end(), 0);
+    list jl;
+    EXPECT_EQ(jl.rbegin(), jl.rend());
+    jl.insert(data.begin(), data.end());
+    std::vector<int> forward = to_vector(jl);
+    EXPECT_TRUE(std::equal(jl.rbegin(), jl.rend(), forward.rbegin(), forward.rend()));
+    auto rit = jl.rbegin();
+    EXPECT_EQ(rit.base(), jl.end());
+    std::advance(rit, 100);
+    EXPECT_EQ(*rit, forward[forward.size() - 101]);
+    std::advance(rit, -100);
+    EXPECT_EQ(rit, jl.rbegin());
+    EXPECT_EQ(*--jl.rend(), forward.front());
+
+    // Without prev pointers a hint is checked against the path found to it.
+    auto pos = std::next(jl.find(44));
+    auto it = jl.emplace_hint(pos, 44 + 256 * 30);
+    EXPECT_EQ(std::next(it), pos);
+    it = jl.emplace_hint(jl.begin(), 255 + 256 * 30);
+    EXPECT_EQ(std::next(it), jl.end());
+    it = jl.emplace_hint(jl.end(), 255);
+    EXPECT_EQ(std::next(it), jl.end());
+    EXPECT_EQ(*jl.rbegin(), 255);
+}
+
+TEST(jump_list, EmplaceAndNodeHandles) {
+    jump_list<std::pair<int, std::string>> pairs;
+    pairs.emplace(2, "b");
+    pairs.emplace(std::piecewise_construct, std::forward_as_tuple(1), std::forward_as_tuple(3, 'a'));
+    auto hinted = pairs.emplace_hint(pairs.end(), 3, "c");
+    EXPECT_EQ(hinted->second, "c");
+    EXPECT_EQ(pairs.begin()->second, "aaa");
+    EXPECT_EQ(pairs.size(), 3u);
+
+    allocation_log log;
+    using list = jump_list<int, std::less<int>, counting_allocator<int>>;
+    list jl({1, 2, 3, 4, 5}, std::less<int>(), counting_allocator<int>(&log));
+    std::size_t allocations = log.allocations;
+    const int* address = &*jl.find(2);
+    list::node_type nh = jl.extract(jl.find(2));
+    ASSERT_FALSE(nh.empty());
+    EXPECT_EQ(nh.get_allocator().log, &log);
+    EXPECT_EQ(jl.size(), 4u);
+    EXPECT_FALSE(jl.contains(2));
+    // Re-keying relinks the same node.
+    nh.value() = 7;
+    auto it = jl.insert(std::move(nh));
+    EXPECT_TRUE(nh.empty());
+    EXPECT_EQ(&*it, address);
+    EXPECT_EQ(to_vector(jl), (std::vector<int>{1, 3, 4, 5, 7}));
+    it = jl.insert(jl.begin(), jl.extract(7));
+    EXPECT_EQ(&*it, address);
+    EXPECT_EQ(to_vector(jl), (std::vector<int>{1, 3, 4, 5, 7}));
+    EXPECT_EQ(log.allocations, allocations);
+
+    EXPECT_TRUE(jl.extract(42).empty());
+    EXPECT_EQ(jl.insert(list::node_type()), jl.end());
+    {
+        list::node_type dropped = jl.extract(jl.begin());
+        EXPECT_EQ(dropped.value(), 1);
+    }
+    EXPECT_EQ(to_vector(jl), (std::vector<int>{3, 4, 5, 7}));
+
+    // Another list with an equal allocator links the same nodes in.
+    list other({6}, std::less<int>(), counting_allocator<int>(&log));
+    allocations = log.allocations;
+    address = &*jl.find(4);
+    EXPECT_EQ(&*other.insert(jl.extract(jl.find(4))), address);
+    address = &*jl.find(5);
+    EXPECT_EQ(&*other.insert(other.end(), jl.extract(jl.find(5))), address);
+    EXPECT_EQ(log.allocations, allocations);
+    EXPECT_EQ(to_vector(other), (std::vector<int>{4, 5, 6}));
+    EXPECT_EQ(to_vector(jl), (std::vector<int>{3, 7}));
+    // Extracted again, a borrowed node goes back to the list it came from.
+    jl.insert(other.extract(4));
+    EXPECT_EQ(to_vector(jl), (std::vector<int>{3, 4, 7}));
+
+    // Handles and borrowed nodes outlive the list they came from, whether
+    // it was cleared, moved from or destroyed. A list with a different
+    // allocator moves the element into a node of its own.
+    allocation_log foreign_log;
+    list foreign{counting_allocator<int>(&foreign_log)};
+    list::node_type dropped;
+    {
+        list source({8, 9, 10}, std::less<int>(), counting_allocator<int>(&log));
+        nh = source.extract(source.find(8));
+        other.insert(source.extract(source.find(9)));
+        list moved(std::move(source));
+        dropped = moved.extract(moved.find(10));
+    }
+    EXPECT_EQ(nh.value(), 8);
+    foreign.insert(std::move(nh));
+    EXPECT_EQ(to_vector(foreign), (std::vector<int>{8}));
+    EXPECT_EQ(to_vector(other), (std::vector<int>{5, 6, 9}));
+    EXPECT_EQ(dropped.value(), 10);
+    dropped = list::node_type();
+    other.clear();
+    EXPECT_EQ(to_vector(jl), (std::vector<int>{3, 4, 7}));
+    jl.clear();
+    EXPECT_EQ(log.live(), 0u);
+
+    jump_list<int, std::less<int>, std::allocator<int>, indexable_traits> indexed{5, 1, 4, 2, 3};
+    auto moved = indexed.extract(indexed.nth(1));
+    moved.value() = 6;
+    indexed.insert(indexed.nth(1), std::move(moved));
+    expect_positions(indexed);
+    EXPECT_EQ(to_vector(indexed), (std::vector<int>{1, 3, 4, 5, 6}));
+
+    fat_list<int> fat;
+    fat.emplace(3);
+    fat.emplace_hint(fat.end(), 1);
+    EXPECT_EQ(to_vector(fat), (std::vector<int>{1, 3}));
+}
+
+TEST(jump_list, SnapshotRoundTrip) {
+    std::vector<std::int64_t> keys(200'000);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = static_cast<std::int64_t>(i * 3 / 2) - 1000;
+    }
+    keys.push_back(std::numeric_limits<std::int64_t>::min());
+    keys.push_back(std::numeric_limits<std::int64_t>::max());
+    jump_list<std::int64_t> jl(keys.begin(), keys.end());
+    std::stringstream ss;
+    jl.save(ss);
+    // Small gaps cost a byte or two per key, so the snapshot spans several
+    // chunks yet stays far below the raw size.
+    EXPECT_LT(ss.str().size(), keys.size() * 2);
+    ss << "tail";
+    jump_list<std::int64_t> loaded{1, 2, 3};
+    loaded.load(ss);
+    EXPECT_EQ(loaded, jl);
+    std::string rest;
+    ss >> rest;
+    EXPECT_EQ(rest, "tail");
+
+    std::stringstream indexed_ss;
+    jump_list<std::int64_t>(keys.begin(), keys.begin() + 2000).save(indexed_ss);
+    jump_list<std::int64_t, std::less<std::int64_t>, std::allocator<std::int64_t>, indexable_traits> indexed;
+    indexed.load(indexed_ss);
+    expect_positions(indexed);
+    fat_list<std::int64_t> fat;
+    std::stringstream fat_ss;
+    jl.save(fat_ss);
+    fat.load(fat_ss);
+    EXPECT_TRUE(std::ranges::equal(fat, jl));
+    compact_list<std::int64_t> compact{4};
+    std::stringstream compact_ss;
+    fat.save(compact_ss);
+    compact.load(compact_ss);
+    EXPECT_TRUE(std::ranges::equal(compact, jl));
+    std::stringstream back_ss;
+    compact.save(back_ss);
+    jump_list<std::int64_t> back;
+    back.load(back_ss);
+    EXPECT_EQ(back, jl);
+
+    jump_list<std::uint8_t, std::greater<>> bytes{0, 255, 7, 7, 128};
+    std::stringstream bytes_ss;
+    bytes.save(bytes_ss);
+    jump_list<std::uint8_t, std::greater<>> bytes_loaded;
+    bytes_loaded.load(bytes_ss);
+    EXPECT_EQ(to_vector(bytes_loaded), (std::vector<std::uint8_t>{255, 128, 7, 7, 0}));
+
+    // Non-integral keys are stored as raw bytes.
+    jump_list<double> doubles{2.5, -1.0, 1e300};
+    std::stringstream doubles_ss;
+    doubles.save(doubles_ss);
+    jump_list<double> doubles_loaded;
+    doubles_loaded.load(doubles_ss);
+    EXPECT_EQ(doubles_loaded, doubles);
+
+    jump_list<std::int64_t> empty;
+    std::stringstream empty_ss;
+    empty.save(empty_ss);
+    loaded.load(empty_ss);
+    EXPECT_TRUE(loaded.empty());
+}
+
+TEST(jump_list, SnapshotRejectsBadInput) {
+    jump_list<int> jl{3, 1, 2};
+    std::stringstream ss;
+    jl.save(ss);
+    std::string good = ss.str();
+
+    auto load = [](const std::string& bytes, auto& target) {
+        std::stringstream in(bytes);
+        EXPECT_THROW(target.load(in), std::runtime_error);
+        EXPECT_TRUE(target.empty());
+        target.insert(42);
+    };
+    jump_list<int> target{5};
+    load("", target);
+    load("XLSNAP" + good.substr(6), target);
+    load(good.substr(0, good.size() - 2), target);
+    jump_list<long long> wider;
+    load(good, wider);
+    jump_list<int, std::greater<>> reversed;
+    load(good, reversed);
+    std::string corrupt = good;
+    corrupt[corrupt.size() - 2] = '\x7f';
+    load(corrupt, target);
+
+    std::stringstream in(good);
+    target.load(in);
+    EXPECT_EQ(target, jl);
+}
+
+TEST(jump_list, CappedTowerHeight) {
+    expect_matches_multiset<jump_list<int, std::less<int>, std::allocator<int>, capped_level_traits<3>>>(
+        [](auto& rng) { return static_cast<int>(rng() % 5000); });
+    expect_matches_multiset<jump_list<int, std::less<int>, std::allocator<int>, capped_level_traits<2>>>(
+        [](auto& rng) { return static_cast<int>(rng() % 500); });
+    std::vector<int> data(3000);
+    std::iota(data.begin(), data.end(), 0);
+    jump_list<int, std::less<int>, std::allocator<int>, capped_level_traits<4>> sorted(sorted_equivalent, data.begin(),
+                                                                                       data.end());
+    EXPECT_EQ(to_vector(sorted), data);
+    EXPECT_EQ(*sorted.find(2999), 2999);
+}
+
+TEST(jump_list, ScansMatchIteration) {
+    jump_list<int> jl;
+    jump_list<int, std::less<int>, std::allocator<int>, capped_level_traits<2>> capped;
+    std::minstd_rand rng(8);
+    for (int i = 0; i < 20000; ++i) {
+        int v = static_cast<int>(rng() % 5000);
+        jl.insert(v);
+        capped.insert(v);
+    }
+    EXPECT_TRUE(std::ranges::equal(jl.scan(), jl));
+    EXPECT_TRUE(std::ranges::equal(capped.scan(), capped));
+    EXPECT_TRUE(jump_list<int>().scan().empty());
+    for (int i = 0; i < 100; ++i) {
+        int lo = static_cast<int>(rng() % 5200) - 100;
+        int hi = lo + static_cast<int>(rng() % 600);
+        std::vector<int> expected(jl.lower_bound(lo), jl.lower_bound(hi));
+        auto range = jl.scan(lo, hi);
+        EXPECT_EQ(range.begin().base(), jl.lower_bound(lo));
+        EXPECT_TRUE(std::ranges::equal(range, expected));
+        std::vector<int> visited;
+        jl.for_each_range(lo, hi, [&](int v) { visited.push_back(v); });
+        EXPECT_EQ(visited, expected);
+    }
+}
+
+TEST(jump_list, FatVisitBlocksCoversRange) {
+    fat_list<int> jl;
+    std::minstd_rand rng(9);
+    for (int i = 0; i < 20000; ++i) {
+        jl.insert(static_cast<int>(rng() % 5000));
+    }
+    std::vector<int> all;
+    jl.visit_blocks([&](std::span<const int> block) {
+        EXPECT_FALSE(block.empty());
+        EXPECT_LE(block.size(), 16u);
+        all.insert(all.end(), block.begin(), block.end());
+    });
+    EXPECT_EQ(all, to_vector(jl));
+    for (int i = 0; i < 100; ++i) {
+        int lo = static_cast<int>(rng() % 5200) - 100;
+        int hi = lo + static_cast<int>(rng() % 600);
+        std::vector<int> expected(jl.lower_bound(lo), jl.lower_bound(hi));
+        std::vector<int> visited;
+        jl.visit_blocks(lo, hi, [&](std::span<const int> block) {
+            visited.insert(visited.end(), block.begin(), block.end());
+        });
+        EXPECT_EQ(visited, expected);
+        visited.clear();
+        jl.for_each_range(lo, hi, [&](int v) { visited.push_back(v); });
+        EXPECT_EQ(visited, expected);
+    }
+}
+
+// Checks that the parts of a partition are non-empty, in order and cover
+// the list, and that none is far off an even share.
+template<typename List>
+void expect_partition(const List& jl, std::size_t n, double slack) {
+    auto parts = jl.partition(n);
+    ASSERT_EQ(parts.size(), std::min(n, jl.size()));
+    auto it = jl.begin();
+    for (const auto& part : parts) {
+        EXPECT_EQ(part.begin(), it);
+        auto len = static_cast<std::size_t>(std::distance(part.begin(), part.end()));
+        EXPECT_GT(len, 0u);
+        EXPECT_LE(static_cast<double>(len), slack * static_cast<double>(jl.size()) / parts.size());
+        it = part.end();
+    }
+    EXPECT_EQ(it, jl.end());
+}
+
+TEST(jump_list, PartitionCoversListEvenly) {
+    std::vector<int> data(100000);
+    std::iota(data.begin(), data.end(), 0);
+    for (unsigned seed : {3u, 4u, 5u, 6u, 7u}) {
+        std::shuffle(data.begin(), data.end(), std::minstd_rand(seed));
+        jump_list<int> jl(data.begin(), data.end());
+        expect_partition(jl, 1, 1.0);
+        expect_partition(jl, 8, 2.5);
+        expect_partition(jl, 64, 2.5);
+        fat_list<int> fat(data.begin(), data.end());
+        expect_partition(fat, 16, 2.5);
+        compact_list<int> compact(data.begin(), data.end());
+        expect_partition(compact, 16, 2.5);
+    }
+    jump_list<int, std::less<int>, std::allocator<int>, indexable_traits> indexed(data.begin(), data.end());
+    expect_partition(indexed, 7, 1.01);
+
+    jump_list<int> tiny{3, 1, 2};
+    expect_partition(tiny, 10, 1.0);
+    EXPECT_TRUE(jump_list<int>().partition(4).empty());
+    EXPECT_TRUE(tiny.partition(0).empty());
+}
+
+TEST(jump_list, ParallelForEachAndReduce) {
+    std::vector<std::int64_t> data(200000);
+    std::iota(data.begin(), data.end(), -1000);
+    jump_list<std::int64_t> jl(sorted_equivalent, data.begin(), data.end());
+    std::int64_t expected = std::accumulate(data.begin(), data.end(), std::int64_t{0});
+
+    std::atomic<std::int64_t> sum{0};
+    std::atomic<std::size_t> visited{0};
+    parallel_for_each(jl, [&](std::int64_t v) {
+        sum.fetch_add(v, std::memory_order_relaxed);
+        visited.fetch_add(1, std::memory_order_relaxed);
+    }, 4);
+    EXPECT_EQ(sum.load(), expected);
+    EXPECT_EQ(visited.load(), data.size());
+
+    EXPECT_EQ(parallel_reduce(jl, std::int64_t{0}, std::plus<>()), expected);
+    EXPECT_EQ(parallel_reduce(jl, std::size_t{7}, std::plus<>(), [](std::int64_t v) { return v % 2 == 0 ? 1u : 0u; },
+                              3),
+              7 + data.size() / 2);
+    fat_list<std::int64_t> fat(sorted_equivalent, data.begin(), data.end());
+    EXPECT_EQ(parallel_reduce(fat, std::int64_t{5}, std::plus<>()), expected + 5);
+    EXPECT_EQ(parallel_reduce(jump_list<int>(), 42, std::plus<>()), 42);
+
+    EXPECT_THROW(parallel_for_each(jl, [](std::int64_t v) {
+        if (v == 150000) {
+            throw std::runtime_error("stop");
+        }
+    }, 4), std::runtime_error);
+}
+
+TEST(jump_list, RebalanceRestoresSearchCost) {
+    // A bulk build gives every second node a taller tower; erasing those
+    // leaves nothing above level 0.
+    std::vector<int> data(8192);
+    std::iota(data.begin(), data.end(), 0);
+    jump_list<int> jl(sorted_equivalent, data.begin(), data.end());
+    jump_list_profile healthy = jl.height_profile();
+    EXPECT_EQ(healthy.nodes[0], data.size());
+    EXPECT_EQ(healthy.nodes[1], data.size() / 2);
+    EXPECT_LT(healthy.actual_cost, healthy.expected_cost);
+    for (auto it = jl.begin(); it != jl.end();) {
+        it = *it % 2 != 0 ? jl.erase(it) : std::next(it);
+    }
+    ASSERT_EQ(jl.size(), data.size() / 2);
+    jump_list_profile degraded = jl.height_profile();
+    EXPECT_EQ(degraded.levels, 1);
+    EXPECT_EQ(degraded.nodes[1], 0u);
+    EXPECT_GT(degraded.actual_cost, 50 * degraded.expected_cost);
+
+    // Bounded steps with modifications in between.
+    std::size_t rebuilt = 0;
+    for (int step = 0; step < 70; ++step) {
+        rebuilt += jl.rebalance(64);
+        if (step % 10 == 0) {
+            jl.erase(jl.find(2 * step));
+            jl.insert(2 * step);
+        }
+    }
+    EXPECT_GT(rebuilt, 0u);
+    // Finish the current sweep, then one full sweep to settle the towers
+    // inserted behind it.
+    jl.rebalance(jl.size());
+    jl.rebalance(jl.size());
+    std::vector<int> evens;
+    for (int v : data) {
+        if (v % 2 == 0) {
+            evens.push_back(v);
+        }
+    }
+    EXPECT_EQ(to_vector(jl), evens);
+    jump_list_profile fixed = jl.height_profile();
+    EXPECT_GT(fixed.levels, 5);
+    EXPECT_LT(fixed.actual_cost, 1.25 * fixed.expected_cost);
+
+    // Another sweep finds nothing left to fix.
+    EXPECT_EQ(jl.rebalance(jl.size()), 0u);
+
+    jump_list<int, std::less<int>, std::allocator<int>, indexable_traits> indexed(sorted_equivalent, evens.begin(),
+                                                                                   evens.end());
+    for (auto it = indexed.begin(); it != indexed.end();) {
+        it = *it % 4 == 0 ? std::next(it) : indexed.erase(it);
+    }
+    EXPECT_GT(indexed.rebalance(indexed.size()), 0u);
+    EXPECT_EQ(indexed.rebalance(indexed.size()), 0u);
+    expect_positions(indexed);
+    EXPECT_LT(indexed.height_profile().actual_cost, 1.25 * indexed.height_profile().expected_cost);
+    EXPECT_EQ(jump_list<int>().rebalance(10), 0u);
+}
+
+TEST(small_jump_list, StaysInlineUntilFull) {
+    allocation_log log;
+    using list = small_jump_list<int, 16, std::less<int>, counting_allocator<int>>;
+    list small{std::less<int>(), counting_allocator<int>(&log)};
+    std::multiset<int> ref;
+    std::minstd_rand rng(5);
+    for (int i = 0; i < 3000; ++i) {
+        int v = static_cast<int>(rng() % 40);
+        if (ref.size() < 16 && rng() % 3 != 0) {
+            small.insert(v);
+            ref.insert(v);
+        } else {
+            EXPECT_EQ(small.erase(v), ref.erase(v));
+        }
+        EXPECT_EQ(small.lower_bound(v) == small.end(), ref.lower_bound(v) == ref.end());
+    }
+    EXPECT_TRUE(small.is_inline());
+    EXPECT_EQ(log.allocations, 0u);
+    EXPECT_TRUE(std::equal(small.begin(), small.end(), ref.begin(), ref.end()));
+    EXPECT_TRUE(std::equal(small.rbegin(), small.rend(), ref.rbegin(), ref.rend()));
+
+    small.clear();
+    for (int v = 15; v >= 0; --v) {
+        small.insert(v);
+    }
+    EXPECT_TRUE(small.is_inline());
+    EXPECT_EQ(*small.find(7), 7);
+    EXPECT_EQ(small.count(20), 0u);
+    EXPECT_EQ(*small.upper_bound(14), 15);
+    small.insert(*small.begin());
+    EXPECT_FALSE(small.is_inline());
+    EXPECT_GT(log.allocations, 0u);
+    EXPECT_EQ(small.size(), 17u);
+    EXPECT_EQ(small.count(0), 2u);
+    EXPECT_EQ(*--small.end(), 15);
+    small.clear();
+    EXPECT_TRUE(small.is_inline());
+    EXPECT_EQ(log.live(), 0u);
+}
+
+TEST(small_jump_list, MatchesMultisetAfterPromotion) {
+    expect_matches_multiset<small_jump_list<int, 16>>([](auto& rng) { return static_cast<int>(rng() % 500); });
+    expect_matches_multiset<small_jump_list<std::uint64_t, 64, std::greater<>>>(
+        [](auto& rng) { return static_cast<std::uint64_t>(rng() % 300) - 150u; });
+    expect_matches_multiset<small_jump_list<double, 5>>([](auto& rng) { return static_cast<double>(rng() % 90) / 4; });
+    expect_matches_multiset<small_jump_list<std::string, 8>>(
+        [](auto& rng) { return std::to_string(rng() % 300); });
+}
+
+TEST(small_jump_list, CopyMoveSwap) {
+    small_jump_list<std::string, 4> a{"d", "b", "a"};
+    small_jump_list<std::string, 4> b{"x", "z", "y", "w", "v"};
+    EXPECT_TRUE(a.is_inline());
+    EXPECT_FALSE(b.is_inline());
+
+    auto a_copy = a;
+    auto b_copy = b;
+    EXPECT_EQ(a_copy, a);
+    EXPECT_EQ(b_copy, b);
+    EXPECT_LT(a, b);
+    swap(a_copy, b_copy);
+    EXPECT_EQ(a_copy, b);
+    EXPECT_EQ(b_copy, a);
+
+    small_jump_list<std::string, 4> moved(std::move(b_copy));
+    EXPECT_TRUE(b_copy.empty());
+    EXPECT_EQ(moved, a);
+    moved = b;
+    EXPECT_EQ(moved, b);
+    moved = std::move(a_copy);
+    EXPECT_EQ(moved, b);
+    EXPECT_TRUE(a_copy.is_inline());
+    moved = {"q"};
+    EXPECT_EQ(to_vector(moved), (std::vector<std::string>{"q"}));
+
+    auto rest = b.erase(b.begin(), b.find("y"));
+    EXPECT_EQ(*rest, "y");
+    EXPECT_EQ(b.size(), 2u);
+    rest = a.erase(a.begin(), a.find("d"));
+    EXPECT_EQ(rest, a.begin());
+    EXPECT_EQ(to_vector(a), (std::vector<std::string>{"d"}));
+}
+
+TEST(jump_list_map, MatchesStdMap) {
+    jump_list_map<int, std::string> jm;
+    std::map<int, std::string> ref;
+    std::minstd_rand rng(11);
+    for (int i = 0; i < 6000; ++i) {
+        int k = static_cast<int>(rng() % 700);
+        std::string v = std::to_string(rng() % 100);
+        switch (rng() % 4) {
+        case 0:
+            EXPECT_EQ(jm.try_emplace(k, v).second, ref.try_emplace(k, v).second);
+            break;
+        case 1:
+            EXPECT_EQ(jm.insert_or_assign(k, v).second, ref.insert_or_assign(k, v).second);
+            break;
+        case 2:
+            jm[k] += v;
+            ref[k] += v;
+            break;
+        default:
+            EXPECT_EQ(jm.erase(k), ref.erase(k));
+        }
+    }
+    ASSERT_EQ(jm.size(), ref.size());
+    auto same = [](const auto& a, const auto& b) { return a.first == b.first && a.second == b.second; };
+    EXPECT_TRUE(std::equal(jm.begin(), jm.end(), ref.begin(), ref.end(), same));
+    EXPECT_TRUE(std::equal(jm.rbegin(), jm.rend(), ref.rbegin(), ref.rend(), same));
+    for (int k = -1; k <= 700; k += 7) {
+        EXPECT_EQ(jm.contains(k), ref.contains(k));
+        auto lb = jm.lower_bound(k);
+        auto rlb = ref.lower_bound(k);
+        EXPECT_EQ(lb == jm.end(), rlb == ref.end());
+        if (rlb != ref.end()) {
+            EXPECT_EQ(lb.key(), rlb->first);
+            EXPECT_EQ(lb->second, rlb->second);
+        }
+        EXPECT_EQ(std::distance(jm.begin(), jm.upper_bound(k)), std::distance(ref.begin(), ref.upper_bound(k)));
+    }
+}
+
+TEST(jump_list_map, ValuesLiveOutOfLine) {
+    struct big {
+        std::array<char, 256> payload{};
+        int id = 0;
+    };
+    jump_list_map<int, big> jm;
+    for (int k = 0; k < 100; ++k) {
+        jm[k].id = k;
+    }
+    // Ascending insertion fills the value pool in key order, one block
+    // after another.
+    auto address = [](const big& v) { return reinterpret_cast<std::uintptr_t>(&v); };
+    std::uintptr_t first = address(jm.begin().value());
+    std::uintptr_t stride = address(std::next(jm.begin()).value()) - first;
+    EXPECT_GE(stride, sizeof(big));
+    EXPECT_LT(stride, sizeof(big) + alignof(std::max_align_t));
+    int k = 0;
+    for (auto it = jm.begin(); it != jm.end(); ++it, ++k) {
+        EXPECT_EQ(it->second.id, k);
+        if (k < 8) {
+            EXPECT_EQ(address(it.value()), first + k * stride);
+        }
+    }
+    big* stable = &jm.at(50);
+    for (int i = 100; i < 400; ++i) {
+        jm.try_emplace(i);
+    }
+    jm.erase(jm.find(49));
+    EXPECT_EQ(&jm.at(50), stable);
+    EXPECT_THROW(jm.at(49), std::out_of_range);
+
+    auto [it, inserted] = jm.try_emplace(50);
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(it.value().id, 50);
+    jump_list_map<int, big>::const_iterator cit = it;
+    EXPECT_EQ(cit, it);
+    EXPECT_EQ(cit.key(), 50);
+}
+
+TEST(jump_list_map, CopyMoveSwap) {
+    allocation_log log;
+    using map = jump_list_map<std::string, std::vector<int>, std::less<std::string>,
+                              counting_allocator<std::pair<const std::string, std::vector<int>>>>;
+    {
+        map a{std::less<std::string>(), map::allocator_type(&log)};
+        a.insert({"b", {2}});
+        a.insert(std::pair<std::string, std::vector<int>>("a", {1, 1}));
+        a["c"].push_back(3);
+        map b = a;
+        EXPECT_EQ(a, b);
+        b["a"].clear();
+        EXPECT_FALSE(a == b);
+        map c = std::move(b);
+        EXPECT_TRUE(b.empty());
+        EXPECT_EQ(c.at("a"), std::vector<int>{});
+        swap(a, c);
+        EXPECT_EQ(a.at("a"), std::vector<int>{});
+        EXPECT_EQ(c.at("a"), (std::vector<int>{1, 1}));
+        a = c;
+        EXPECT_EQ(a, c);
+        a.clear();
+        EXPECT_EQ(a.begin(), a.end());
+        a["z"];
+        EXPECT_EQ(a.size(), 1u);
+    }
+    EXPECT_EQ(log.live(), 0u);
+}
+
+#if __has_include(<sys/mman.h>)
+TEST(mapped_jump_list, PersistsAcrossReopen) {
+    auto path = std::filesystem::temp_directory_path() / ("mapped_jump_list_" + std::to_string(::getpid()));
+    std::filesystem::remove(path);
+    std::multiset<std::int64_t> ref;
+    std::minstd_rand rng(29);
+    {
+        // Tiny initial size, so the file grows and is remapped many times.
+        mapped_jump_list<std::int64_t> ml(path, 4096);
+        auto first = ml.insert(-1);
+        ref.insert(-1);
+        for (int i = 0; i < 20000; ++i) {
+            std::int64_t v = static_cast<std::int64_t>(rng() % 5000);
+            if (rng() % 3 != 0) {
+                ml.insert(v);
+                ref.insert(v);
+            } else {
+                EXPECT_EQ(ml.erase(v), ref.erase(v));
+            }
+        }
+        // Iterators hold offsets and survive the remaps.
+        EXPECT_EQ(*first, -1);
+        EXPECT_GT(ml.mapped_bytes(), 4096u);
+        ml.flush();
+    }
+    {
+        mapped_jump_list<std::int64_t> ml(path);
+        ASSERT_EQ(ml.size(), ref.size());
+        EXPECT_TRUE(std::equal(ml.begin(), ml.end(), ref.begin(), ref.end()));
+        EXPECT_TRUE(std::equal(ml.rbegin(), ml.rend(), ref.rbegin(), ref.rend()));
+        for (std::int64_t v = 0; v < 200; ++v) {
+            EXPECT_EQ(ml.count(v), ref.count(v));
+            EXPECT_EQ(ml.contains(v), ref.contains(v));
+            EXPECT_EQ(std::distance(ml.begin(), ml.lower_bound(v)), std::distance(ref.begin(), ref.lower_bound(v)));
+            EXPECT_EQ(std::distance(ml.begin(), ml.upper_bound(v)), std::distance(ref.begin(), ref.upper_bound(v)));
+        }
+        // Freed nodes are reused before the file grows again. With the
+        // list emptied, new towers stay low, and plenty of those are free.
+        std::size_t used = ml.used_bytes();
+        while (!ml.empty()) {
+            ml.erase(ml.begin());
+        }
+        for (std::int64_t v = 0; v < 100; ++v) {
+            ml.insert(v);
+        }
+        EXPECT_EQ(ml.used_bytes(), used);
+        ml.clear();
+        EXPECT_TRUE(ml.empty());
+        EXPECT_EQ(ml.begin(), ml.end());
+    }
+
+    // A different element type or offset width is rejected, as is a foreign
+    // file.
+    EXPECT_THROW((mapped_jump_list<std::int32_t>(path)), std::runtime_error);
+    EXPECT_THROW((mapped_jump_list<std::int64_t, std::less<std::int64_t>, std::uint64_t>(path)), std::runtime_error);
+    {
+        std::FILE* f = std::fopen(path.c_str(), "r+b");
+        ASSERT_NE(f, nullptr);
+        std::fputs("garbage!", f);
+        std::fclose(f);
+    }
+    EXPECT_THROW((mapped_jump_list<std::int64_t>(path)), std::runtime_error);
+    std::filesystem::remove(path);
+}
+#endif
+
+TEST(concurrent_jump_list, SingleThreaded) {
+    concurrent_jump_list<int> cl{3, 1, 4, 1, 5};
+    EXPECT_EQ(cl.size(), 4u);
+    EXPECT_TRUE(cl.contains(4));
+    EXPECT_FALSE(cl.insert(3));
+    EXPECT_EQ(cl.find(5), std::optional<int>(5));
+    EXPECT_EQ(cl.find(2), std::nullopt);
+    EXPECT_TRUE(cl.erase(1));
+    EXPECT_FALSE(cl.erase(1));
+    EXPECT_FALSE(cl.contains(1));
+    EXPECT_TRUE(cl.insert(1));
+    EXPECT_EQ(cl.size(), 4u);
+}
+
+TEST(concurrent_jump_list, ConcurrentDisjointInserts) {
+    concurrent_jump_list<int> cl;
+    constexpr int threads = 4;
+    constexpr int per_thread = 5000;
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&cl, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                EXPECT_TRUE(cl.insert(i * threads + t));
+            }
+        });
+    }
+    for (auto& th : pool) {
+        th.join();
+    }
+    EXPECT_EQ(cl.size(), static_cast<std::size_t>(threads * per_thread));
+    for (int i = 0; i < threads * per_thread; ++i) {
+        EXPECT_TRUE(cl.contains(i));
+    }
+}
+
+TEST(concurrent_jump_list, ConcurrentInsertEraseSameKeys) {
+    concurrent_jump_list<std::string> cl;
+    constexpr int threads = 4;
+    constexpr int keys = 64;
+    std::atomic<int> balance[keys] = {};
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            std::minstd_rand rng(t + 1);
+            for (int i = 0; i < 20000; ++i) {
+                int k = static_cast<int>(rng() % keys);
+                std::string key = std::to_string(k);
+                if (rng() % 2) {
+                    if (cl.insert(key)) {
+                        balance[k].fetch_add(1);
+                    }
+                } else if (cl.erase(key)) {
+                    balance[k].fetch_sub(1);
+                }
+                cl.contains(key);
+            }
+        });
+    }
+    for (auto& th : pool) {
+        th.join();
+    }
+    std::size_t present = 0;
+    for (int k = 0; k < keys; ++k) {
+        int b = balance[k].load();
+        EXPECT_TRUE(b == 0 || b == 1);
+        EXPECT_EQ(cl.contains(std::to_string(k)), b == 1);
+        present += static_cast<std::size_t>(b);
+    }
+    EXPECT_EQ(cl.size(), present);
+}
+
+TEST(epoch_reclamation, PinnedReaderDelaysFree) {
+    static std::atomic<int> freed{0};
+    struct tracked {
+        ~tracked() { freed.fetch_add(1); }
+    };
+    freed = 0;
+
+    std::atomic<bool> pinned{false};
+    std::atomic<bool> release{false};
+    std::thread reader([&] {
+        epoch_guard guard;
+        pinned = true;
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    });
+    while (!pinned.load()) {
+        std::this_thread::yield();
+    }
+
+    {
+        epoch_guard guard;
+        EXPECT_TRUE(epoch_domain::global().is_pinned());
+        epoch_domain::global().retire(new tracked);
+    }
+    EXPECT_FALSE(epoch_domain::global().is_pinned());
+    for (int i = 0; i < 10; ++i) {
+        epoch_domain::global().collect();
+    }
+    EXPECT_EQ(freed.load(), 0);
+
+    release = true;
+    reader.join();
+    epoch_domain::global().synchronize();
+    EXPECT_EQ(freed.load(), 1);
+}
+
+TEST(epoch_reclamation, GuardsNestAndMove) {
+    epoch_guard outer;
+    {
+        epoch_guard inner = outer;
+        epoch_guard moved = std::move(inner);
+        EXPECT_FALSE(inner);
+        EXPECT_TRUE(moved);
+    }
+    EXPECT_TRUE(epoch_domain::global().is_pinned());
+    outer.reset();
+    EXPECT_FALSE(epoch_domain::global().is_pinned());
+}
+
+// The domain must outlive the thread_local handles that collect into it
+// as threads, the main one included, shut down, whatever order they are
+// destroyed in next to the coroutine frame caches find_async() keeps. The
+// static lookup frees its frame after the main thread's cache is gone.
+[[noreturn]] static void use_thread_locals_and_exit() {
+    static jump_list<int> jl{1, 2, 3};
+    std::thread worker([] {
+        epoch_guard guard;
+        epoch_domain::global().retire(new int(1));
+        if (jl.find_async(2).get() != jl.find(2)) {
+            std::exit(1);
+        }
+    });
+    worker.join();
+    {
+        epoch_guard guard;
+        epoch_domain::global().retire(new int(2));
+    }
+    if (jl.find_async(3).get() != jl.find(3)) {
+        std::exit(1);
+    }
+    static auto pending = jl.find_async(1);
+    std::exit(0);
+}
+
+TEST(epoch_reclamation, ProcessExitsCleanly) {
+    EXPECT_EXIT(use_thread_locals_and_exit(), ::testing::ExitedWithCode(0), "");
+}
+
+TEST(concurrent_jump_list, Iteration) {
+    concurrent_jump_list<int> cl;
+    for (int i = 20; i > 0; --i) {
+        cl.insert(i);
+    }
+    cl.erase(10);
+    std::vector<int> seen(cl.begin(), cl.end());
+    std::vector<int> expected;
+    for (int i = 1; i <= 20; ++i) {
+        if (i != 10) {
+            expected.push_back(i);
+        }
+    }
+    EXPECT_EQ(seen, expected);
+    EXPECT_EQ(*cl.lower_bound(10), 11);
+    EXPECT_EQ(cl.lower_bound(21), cl.end());
+    EXPECT_FALSE(epoch_domain::global().is_pinned());
+}
+
+TEST(concurrent_jump_list, ScansDuringErasure) {
+    concurrent_jump_list<std::string> cl;
+    constexpr int keys = 2000;
+    auto key = [](int i) {
+        std::string s = std::to_string(i);
+        return std::string(6 - s.size(), '0') + s;
+    };
+    for (int i = 0; i < keys; ++i) {
+        cl.insert(key(i));
+    }
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        std::minstd_rand rng(5);
+        while (!stop.load()) {
+            int k = static_cast<int>(rng() % keys);
+            cl.erase(key(k));
+            cl.insert(key(k));
+        }
+    });
+    for (int round = 0; round < 50; ++round) {
+        std::string last;
+        std::size_t count = 0;
+        for (const auto& s : cl) {
+            EXPECT_LT(last, s);
+            last = s;
+            ++count;
+        }
+        EXPECT_LE(count, static_cast<std::size_t>(keys));
+    }
+    stop = true;
+    writer.join();
+    EXPECT_EQ(cl.size(), static_cast<std::size_t>(keys));
+}
+
+TEST(concurrent_jump_list, SnapshotKeepsItsVersion) {
+    concurrent_jump_list<int> cl;
+    for (int i = 0; i < 100; ++i) {
+        cl.insert(i);
+    }
+    auto snap = cl.snapshot();
+    for (int i = 0; i < 100; i += 2) {
+        cl.erase(i);
+    }
+    for (int i = 100; i < 150; ++i) {
+        cl.insert(i);
+    }
+    EXPECT_TRUE(cl.insert(10));
+    EXPECT_FALSE(cl.insert(11));
+
+    std::vector<int> all(100);
+    std::iota(all.begin(), all.end(), 0);
+    EXPECT_EQ(std::vector<int>(snap.begin(), snap.end()), all);
+    EXPECT_TRUE(snap.contains(4));
+    EXPECT_FALSE(snap.contains(120));
+    EXPECT_EQ(snap.find(10), std::optional<int>(10));
+    EXPECT_EQ(*snap.lower_bound(42), 42);
+    EXPECT_EQ(snap.lower_bound(100), snap.end());
+
+    EXPECT_FALSE(cl.contains(4));
+    EXPECT_TRUE(cl.contains(10));
+    EXPECT_EQ(cl.size(), 101u);
+    EXPECT_EQ(std::distance(cl.begin(), cl.end()), 101);
+
+    // A later snapshot sees the erasures; moving a view keeps it alive.
+    auto later = cl.snapshot();
+    EXPECT_GT(later.version(), snap.version());
+    auto moved = std::move(later);
+    EXPECT_FALSE(moved.contains(4));
+    EXPECT_EQ(std::distance(moved.begin(), moved.end()), 101);
+    EXPECT_FALSE(epoch_domain::global().is_pinned());
+}
+
+TEST(concurrent_jump_list, SnapshotDefersReclamation) {
+    static std::atomic<int> live{0};
+    struct tracked {
+        int key;
+        explicit tracked(int k) : key(k) { live.fetch_add(1); }
+        tracked(const tracked& other) : key(other.key) { live.fetch_add(1); }
+        ~tracked() { live.fetch_sub(1); }
+        bool operator<(const tracked& other) const { return key < other.key; }
+    };
+    live = 0;
+    {
+        concurrent_jump_list<tracked> cl;
+        for (int i = 0; i < 200; ++i) {
+            cl.insert(tracked(i));
+        }
+        std::optional<concurrent_jump_list<tracked>::snapshot_view> snap(cl.snapshot());
+        for (int i = 0; i < 200; ++i) {
+            cl.erase(tracked(i));
+        }
+        epoch_domain::global().synchronize();
+        EXPECT_EQ(live.load(), 200);
+        EXPECT_EQ(std::distance(snap->begin(), snap->end()), 200);
+
+        snap.reset();
+        epoch_domain::global().synchronize();
+        EXPECT_EQ(live.load(), 0);
+        EXPECT_TRUE(cl.empty());
+    }
+    EXPECT_EQ(live.load(), 0);
+}
+
+TEST(concurrent_jump_list, SnapshotsStayConsistentUnderWrites) {
+    // A single writer slides a window of consecutive keys, so every state
+    // it passes through is a contiguous range.
+    concurrent_jump_list<int> cl;
+    constexpr int window = 500;
+    for (int i = 0; i < window; ++i) {
+        cl.insert(i);
+    }
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        for (int i = window; !stop.load(); ++i) {
+            cl.insert(i);
+            cl.erase(i - window);
+        }
+    });
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&] {
+            for (int round = 0; round < 100; ++round) {
+                auto snap = cl.snapshot();
+                std::vector<int> first(snap.begin(), snap.end());
+                ASSERT_GE(first.size(), static_cast<std::size_t>(window));
+                ASSERT_LE(first.size(), static_cast<std::size_t>(window) + 1);
+                for (std::size_t i = 1; i < first.size(); ++i) {
+                    ASSERT_EQ(first[i], first[i - 1] + 1);
+                }
+                std::vector<int> second(snap.begin(), snap.end());
+                ASSERT_EQ(first, second);
+                EXPECT_TRUE(snap.contains(first.front()));
+                EXPECT_FALSE(snap.contains(first.back() + 1));
+            }
+        });
+    }
+    for (auto& th : readers) {
+        th.join();
+    }
+    stop = true;
+    writer.join();
+    EXPECT_EQ(cl.size(), static_cast<std::size_t>(window));
+}
+
+TEST(sharded_jump_list, MatchesMultisetAndSplits) {
+    sharded_jump_list<int, 8> sl(300);
+    std::multiset<int> reference;
+    std::minstd_rand rng(17);
+    for (int i = 0; i < 20000; ++i) {
+        int v = static_cast<int>(rng() % 50000);
+        sl.insert(v);
+        reference.insert(v);
+    }
+    for (int i = 0; i < 50; ++i) {
+        sl.emplace(7);
+        reference.insert(7);
+    }
+    EXPECT_EQ(sl.size(), reference.size());
+    std::vector<int> scanned;
+    for (int v : sl) {
+        scanned.push_back(v);
+    }
+    EXPECT_TRUE(std::ranges::equal(scanned, reference));
+
+    // Every shard took part, and none kept much more than its share.
+    auto sizes = sl.shard_sizes();
+    EXPECT_TRUE(std::ranges::none_of(sizes, [](std::size_t n) { return n == 0; }));
+    EXPECT_LT(std::ranges::max(sizes), reference.size() / 2);
+
+    for (int k : {7, 0, 123, 49999, 50000}) {
+        EXPECT_EQ(sl.count(k), reference.count(k));
+        EXPECT_EQ(sl.contains(k), reference.contains(k));
+        EXPECT_EQ(sl.find(k).has_value(), reference.contains(k));
+        auto it = sl.lower_bound(k);
+        auto expected = reference.lower_bound(k);
+        if (expected == reference.end()) {
+            EXPECT_TRUE(it == sl.end());
+        } else {
+            ASSERT_FALSE(it == sl.end());
+            EXPECT_EQ(*it, *expected);
+        }
+    }
+    EXPECT_EQ(sl.erase(7), reference.erase(7));
+    EXPECT_FALSE(sl.contains(7));
+    EXPECT_EQ(sl.size(), reference.size());
+    sl.clear();
+    EXPECT_TRUE(sl.empty());
+    EXPECT_TRUE(sl.begin() == sl.end());
+
+    sharded_jump_list<std::string, 4, std::less<>> named(std::vector<std::string>{"g", "p"});
+    for (std::string s : {"zebra", "apple", "kiwi", "grape", "plum"}) {
+        named.insert(s);
+    }
+    EXPECT_EQ(named.shard_sizes(), (std::array<std::size_t, 4>{1, 2, 2, 0}));
+    EXPECT_TRUE(named.contains(std::string_view("kiwi")));
+    EXPECT_THROW((sharded_jump_list<int, 2>(std::vector<int>{1, 2})), std::invalid_argument);
+    EXPECT_THROW((sharded_jump_list<int, 4>(std::vector<int>{2, 1})), std::invalid_argument);
+}
+
+TEST(sharded_jump_list, ScansStayOrderedWhileShardsSplit) {
+    // Even keys are inserted up front and never touched, so every scan must
+    // see each of them exactly once while writers add odd keys and push the
+    // boundaries around.
+    sharded_jump_list<int, 8> sl(256);
+    constexpr int stable = 4000;
+    for (int i = 0; i < stable; ++i) {
+        sl.insert(2 * i);
+    }
+    constexpr int writers = 3;
+    constexpr int per_writer = 6000;
+    std::atomic<std::size_t> odd_expected{0};
+    std::vector<std::thread> pool;
+    for (int t = 0; t < writers; ++t) {
+        pool.emplace_back([&, t] {
+            // Writers own disjoint odd keys, so erasures count exactly.
+            std::minstd_rand rng(t + 1);
+            std::size_t kept = 0;
+            for (int i = 0; i < per_writer; ++i) {
+                int v = 2 * (static_cast<int>(rng() % (stable / writers)) * writers + t) + 1;
+                sl.insert(v);
+                ++kept;
+                EXPECT_TRUE(sl.contains(v));
+                if (i % 3 == 0) {
+                    kept -= sl.erase(v);
+                }
+            }
+            odd_expected += kept;
+        });
+    }
+    pool.emplace_back([&] {
+        for (int round = 0; round < 20; ++round) {
+            int evens = 0;
+            int last = std::numeric_limits<int>::min();
+            for (int v : sl) {
+                ASSERT_LE(last, v);
+                last = v;
+                if (v % 2 == 0) {
+                    ASSERT_EQ(v, 2 * evens);
+                    ++evens;
+                }
+            }
+            ASSERT_EQ(evens, stable);
+        }
+    });
+    for (auto& th : pool) {
+        th.join();
+    }
+    std::size_t odd = 0;
+    for (int v : sl) {
+        odd += v % 2;
+    }
+    EXPECT_EQ(sl.size(), stable + odd);
+    EXPECT_EQ(odd, odd_expected.load());
+}
+
+TEST(buffered_jump_list, MatchesMultiset) {
+    expect_matches_multiset<buffered_jump_list<int, 16>>([](auto& rng) { return static_cast<int>(rng() % 500); });
+    expect_matches_multiset<buffered_jump_list<std::uint64_t, 64, std::greater<>>>(
+        [](auto& rng) { return static_cast<std::uint64_t>(rng() % 300) - 150u; });
+    expect_matches_multiset<buffered_jump_list<std::string, 8>>(
+        [](auto& rng) { return std::to_string(rng() % 300); });
+}
+
+TEST(buffered_jump_list, FlushKeepsInsertionOrder) {
+    struct by_first {
+        bool operator()(const std::pair<int, int>& a, const std::pair<int, int>& b) const {
+            return a.first < b.first;
+        }
+    };
+    buffered_jump_list<std::pair<int, int>, 8, by_first> bl;
+    std::minstd_rand rng(5);
+    for (int i = 0; i < 1000; ++i) {
+        bl.emplace(static_cast<int>(rng() % 20), i);
+        EXPECT_LE(bl.buffered(), 8u);
+    }
+    EXPECT_GT(bl.buffered(), 0u);
+    auto check = [&] {
+        EXPECT_EQ(bl.size(), 1000u);
+        EXPECT_TRUE(std::is_sorted(bl.begin(), bl.end(), by_first{}));
+        std::vector<int> last(20, -1);
+        for (const auto& [key, seq] : bl) {
+            EXPECT_GT(seq, last[static_cast<std::size_t>(key)]);
+            last[static_cast<std::size_t>(key)] = seq;
+        }
+    };
+    check();
+    bl.flush();
+    EXPECT_EQ(bl.buffered(), 0u);
+    check();
+
+    buffered_jump_list<std::string, 4, std::less<>> named{"pear", "fig"};
+    named.insert({"kiwi", "apple", "plum"});
+    EXPECT_EQ(named.buffered(), 3u);
+    EXPECT_TRUE(named.contains(std::string_view("apple")));
+    EXPECT_TRUE(named.contains(std::string_view("fig")));
+    EXPECT_EQ(*named.lower_bound(std::string_view("g")), "kiwi");
+    EXPECT_EQ(to_vector(named), (std::vector<std::string>{"apple", "fig", "kiwi", "pear", "plum"}));
+    auto copy = named;
+    EXPECT_EQ(copy, named);
+    copy.erase(copy.find("pear"));
+    EXPECT_GT(copy, named);
+    EXPECT_EQ(copy.size(), 4u);
+}
+
+// A comparator that throws once it has been called budget times.
+struct exhaustible_less {
+    int* budget;
+
+    template<typename A, typename B>
+    bool operator()(const A& a, const B& b) const {
+        if ((*budget)-- == 0) {
+            throw std::runtime_error("out of comparisons");
+        }
+        return std::less<>()(a, b);
+    }
+};
+
+TEST(buffered_jump_list, FlushSurvivesThrowingComparator) {
+    // A short buffer is linked in with resumed searches, a long one merged
+    // along level 0; either way no element may be lost or duplicated.
+    for (int existing : {2000, 24}) {
+        for (int budget_at_flush = 0; budget_at_flush < 40; budget_at_flush += 3) {
+            int budget = std::numeric_limits<int>::max();
+            buffered_jump_list<std::string, 8, exhaustible_less> bl{exhaustible_less{&budget}};
+            std::multiset<std::string> expected;
+            for (int i = 0; i < existing + 8; ++i) {
+                std::string s = "element number " + std::to_string(i * 7919 % 10007);
+                bl.insert(s);
+                expected.insert(s);
+            }
+            ASSERT_EQ(bl.buffered(), 8u);
+            budget = budget_at_flush;
+            try {
+                bl.flush();
+            } catch (const std::runtime_error&) {
+            }
+            budget = std::numeric_limits<int>::max();
+            EXPECT_EQ(bl.size(), expected.size());
+            EXPECT_TRUE(std::ranges::equal(bl, expected));
+        }
+    }
+
+    // Elements of another type are built into a node before the merge
+    // compares them; the node must not leak when that throws.
+    int budget = std::numeric_limits<int>::max();
+    jump_list<std::string, exhaustible_less> jl({"b", "d", "f"}, exhaustible_less{&budget});
+    std::vector<const char*> more{"a long string that needs a heap buffer", "c long string that needs a heap buffer"};
+    budget = 1;
+    EXPECT_THROW(jl.insert_sorted(more), std::runtime_error);
+    budget = std::numeric_limits<int>::max();
+    EXPECT_LE(jl.size(), 5u);
+    EXPECT_TRUE(std::is_sorted(jl.begin(), jl.end()));
 }
 
 // Main function for running tests